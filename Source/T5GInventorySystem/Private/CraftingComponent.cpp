@@ -1,5 +1,7 @@
 ﻿
 #include "CraftingComponent.h"
+#include "InventoryLog.h"
+#include "InventoryStats.h"
 #include "Net/UnrealNetwork.h"
 
 UCraftingComponent::UCraftingComponent()
@@ -58,14 +60,18 @@ void UCraftingComponent::InitializeCraftingStation()
 	// If there is no input inventory, the crafting component is invalid.
 	if (!IsValid(mInventoryInput))
 	{
-		UE_LOG(LogTemp, Error, TEXT("%s(%s): No input inventory set. Crafting Component will not work properly!"),
-			*GetName(), GetOwner()->HasAuthority()?TEXT("SERVER"):TEXT("CLIENT"));
+		UE_LOGFMT(LogInventory, Error,
+			"{Crafting}({Sv}): No input inventory set. Crafting Component will not work properly!",
+			GetName(), GetOwner()->HasAuthority()?"SRV":"CLI");
 		return;
 	}
 	
 	// If there is no output inventory, use the input inventory as dual purpose
 	if (!IsValid(mInventoryOutput))
+	{
 		mInventoryOutput = mInventoryInput;
+		MARK_INVENTORY_PROPERTY_DIRTY(UCraftingComponent, mInventoryOutput);
+	}
 
 	bCraftingReady = true;
 	
@@ -142,10 +148,14 @@ void UCraftingComponent::SetInputInventory(UInventoryComponent* inputInventory)
 	if (IsValid(inputInventory))
 	{
 		mInventoryInput = inputInventory;
+		MARK_INVENTORY_PROPERTY_DIRTY(UCraftingComponent, mInventoryInput);
 		InitializeCraftingStation();
 	}
 	else
+	{
 		mInventoryInput = nullptr;
+		MARK_INVENTORY_PROPERTY_DIRTY(UCraftingComponent, mInventoryInput);
+	}
 }
 
 void UCraftingComponent::SetOutputInventory(UInventoryComponent* outputInventory)
@@ -155,7 +165,8 @@ void UCraftingComponent::SetOutputInventory(UInventoryComponent* outputInventory
 		mInventoryOutput = outputInventory;
 	}
 	else
-		mInventoryInput = nullptr;
+		mInventoryOutput = nullptr;
+	MARK_INVENTORY_PROPERTY_DIRTY(UCraftingComponent, mInventoryOutput);
 }
 
 bool UCraftingComponent::RequestToCraft(const UItemDataAsset* RecipeData)
@@ -234,22 +245,17 @@ bool UCraftingComponent::ConsumeIngredients(int idx)
 	//const UCraftingItemData* recipeData = qData.ItemAsset;
 
 	/*
+	// Deducts all the ingredients, or none of them if any is missing
+	TMap<FName, int> ingredients;
 	for (const TPair<FStItemData, int> craftRecipe : recipeData->Ingredients)
 	{
-		// If we hit an ingredient that isn't present, return and continue onto the next
-		if (mInventoryInput->GetTotalQuantityByItem(craftRecipe.Key) < craftRecipe.Value)
-		{
-			return false;
-		}
+		INVENTORY_DEBUG_LOG(bShowDebug, Display, "{Crafting}({Sv}): Consuming x{Quantity} of '{ItemName}' for crafting.",
+			GetName(), GetOwner()->HasAuthority()?"SRV":"CLI", craftRecipe.Value, craftRecipe.Key.ToString());
+		ingredients.FindOrAdd(craftRecipe.Key.Data->GetPrimaryAssetId().PrimaryAssetName) += craftRecipe.Value;
 	}
-
-	// If all ingredients are present, deduct them, then tick
-	for (const TPair<FStItemData, int> craftRecipe : recipeData->Ingredients)
+	if (!mInventoryInput->RemoveItems(ingredients))
 	{
-		UE_LOG(LogTemp, Display, TEXT("%s(%s): Consuming x%d of '%s' for crafting."),
-			*GetName(), GetOwner()->HasAuthority()?TEXT("SERVER"):TEXT("CLIENT"),
-			craftRecipe.Value, *craftRecipe.Key.ToString());
-		mInventoryInput->RemoveItemByQuantity(craftRecipe.Key, craftRecipe.Value);
+		return false;
 	}
 	*/
 	return true;
@@ -257,6 +263,7 @@ bool UCraftingComponent::ConsumeIngredients(int idx)
 
 void UCraftingComponent::TickCraftingItem(int idx)
 {
+	INVENTORY_SCOPE_CYCLE_COUNTER(STAT_InventoryCraftingTick);
 	if (!bCraftingReady) return;
 	/*
 	if (mCraftingQueue.IsValidIndex(idx))
@@ -383,7 +390,16 @@ void UCraftingComponent::CompleteCraftingItem(int queueSlot)
 void UCraftingComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
-	DOREPLIFETIME_CONDITION(UCraftingComponent, mInventoryInput, COND_OwnerOnly);
-	DOREPLIFETIME_CONDITION(UCraftingComponent, mInventoryOutput, COND_OwnerOnly);
+	FDoRepLifetimeParams PushParams;
+	PushParams.bIsPushBased = true;
+	PushParams.Condition	= COND_OwnerOnly;
+	DOREPLIFETIME_WITH_PARAMS_FAST(UCraftingComponent, mInventoryInput, PushParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UCraftingComponent, mInventoryOutput, PushParams);
 	//DOREPLIFETIME(UCraftingComponent, mCraftingQueue);
 }
+
+void UCraftingComponent::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+	Super::PreReplication(ChangedPropertyTracker);
+	COUNT_INVENTORY_PUSH_COMPARES_AVOIDED(NumPushProperties);
+}
@@ -2,7 +2,54 @@
 
 
 #include "Data/ItemStatics.h"
+
+#include "ItemDefinitionSubsystem.h"
+#include "Engine/AssetManager.h"
 #include "lib/ItemData.h"
+#include "UObject/CoreNet.h"
+
+
+namespace
+{
+	// Which of the optional fields follow in the replicated form
+	enum EItemStaticsNetFields : uint8
+	{
+		HasDurability	= 1 << 0,
+		HasCrafter		= 1 << 1,
+		HasTimestamp	= 1 << 2,
+		IsEquipped		= 1 << 3,
+	};
+	constexpr uint32 NumNetFieldBits = 4;
+
+	// Rarities are replicated as an index into this table. Zero is no rarity,
+	// and 'OtherRarity' means the tag itself follows.
+	constexpr uint32 NumRarityBits = 3;
+	constexpr uint8 OtherRarity = (1 << NumRarityBits) - 1;
+
+	const FGameplayTag& GetRarityTag(uint8 RarityIndex)
+	{
+		static const FGameplayTag RarityTags[] = {
+			FGameplayTag(),
+			TAG_Item_Rarity_Trash.GetTag(),
+			TAG_Item_Rarity_Common.GetTag(),
+			TAG_Item_Rarity_Uncommon.GetTag(),
+			TAG_Item_Rarity_Rare.GetTag(),
+			TAG_Item_Rarity_Legendary.GetTag(),
+			TAG_Item_Rarity_Divine.GetTag(),
+		};
+		static_assert(UE_ARRAY_COUNT(RarityTags) <= OtherRarity, "Too many rarities for the index bits");
+		return RarityIndex < UE_ARRAY_COUNT(RarityTags) ? RarityTags[RarityIndex] : RarityTags[0];
+	}
+
+	uint8 GetRarityIndex(const FGameplayTag& Rarity)
+	{
+		for (uint8 RarityIndex = 0; RarityIndex < OtherRarity; RarityIndex++)
+		{
+			if (GetRarityTag(RarityIndex) == Rarity) { return RarityIndex; }
+		}
+		return OtherRarity;
+	}
+}
 
 
 FItemStatics::FItemStatics(const UItemDataAsset* DataAsset)
@@ -22,3 +69,88 @@ FItemStatics::FItemStatics(const UItemDataAsset* DataAsset)
 		}
 	}
 }
+
+
+const UItemDataAsset* FItemStatics::GetItemData() const
+{
+	if (ItemName.IsNone()) { return nullptr; }
+
+	FItemDefinitionCache& Cache = FItemDefinitionCache::Get();
+	const FItemDefinitionId ItemId = Cache.FindOrAddItemId(ItemName);
+	const FItemDefinition* Definition = Cache.Find(ItemId);
+	if (Definition == nullptr)
+	{
+		return nullptr;
+	}
+	if (Definition->DataAsset.IsValid())
+	{
+		return Definition->DataAsset.Get();
+	}
+
+	const UItemDataAsset* DataAsset = Cast<UItemDataAsset>(
+		UAssetManager::Get().GetPrimaryAssetObject(Definition->AssetId));
+	Cache.RegisterAsset(ItemId, DataAsset);
+	return DataAsset;
+}
+
+
+bool FItemStatics::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	uint8 Fields = 0;
+	uint8 RarityIndex = 0;
+	if (Ar.IsSaving())
+	{
+		if (Durability >= 0.f)				{ Fields |= HasDurability; }
+		if (!CrafterName.IsNone())			{ Fields |= HasCrafter; }
+		if (CraftTimestamp.GetTicks() != 0)	{ Fields |= HasTimestamp; }
+		if (bIsEquipped)					{ Fields |= IsEquipped; }
+		RarityIndex = GetRarityIndex(Rarity);
+	}
+
+	Ar.SerializeBits(&Fields, NumNetFieldBits);
+	Ar.SerializeBits(&RarityIndex, NumRarityBits);
+	UPackageMap::StaticSerializeName(Ar, ItemName);
+
+	bOutSuccess = true;
+	if (RarityIndex == OtherRarity)
+	{
+		Rarity.NetSerialize(Ar, Map, bOutSuccess);
+	}
+	else if (Ar.IsLoading())
+	{
+		Rarity = GetRarityTag(RarityIndex);
+	}
+
+	// Sent at full precision, so the client compares equal to the server
+	float NetDurability = -1.f;
+	if (Fields & HasDurability)
+	{
+		if (Ar.IsSaving()) { NetDurability = Durability; }
+		Ar << NetDurability;
+	}
+
+	FName NetCrafterName;
+	if (Fields & HasCrafter)
+	{
+		if (Ar.IsSaving()) { NetCrafterName = CrafterName; }
+		UPackageMap::StaticSerializeName(Ar, NetCrafterName);
+	}
+
+	int64 CraftTicks = 0;
+	if (Fields & HasTimestamp)
+	{
+		if (Ar.IsSaving()) { CraftTicks = CraftTimestamp.GetTicks(); }
+		Ar << CraftTicks;
+	}
+
+	if (Ar.IsLoading())
+	{
+		Durability		= (Fields & HasDurability) ? NetDurability : -1.f;
+		CrafterName		= NetCrafterName;
+		CraftTimestamp	= FDateTime(CraftTicks);
+		bIsEquipped		= (Fields & IsEquipped) != 0;
+	}
+
+	bOutSuccess &= !Ar.IsError();
+	return true;
+}
@@ -3,6 +3,7 @@
 
 #include "FuelComponent.h"
 
+#include "InventoryStats.h"
 #include "NavigationSystemTypes.h"
 #include "PickupActorBase.h"
 #include "lib/FuelData.h"
@@ -64,6 +65,7 @@ void UFuelComponent::InitializeFuelSystem()
 				const FStFuelData fuelData = mCurrentFuelItem;
 				const FTimespan fuelTime = FTimespan(fuelData.burnTime);
 				mTimeRemaining = fuelTime.GetTotalSeconds();
+				MARK_INVENTORY_PROPERTY_DIRTY(UFuelComponent, mTimeRemaining);
 			}
 		
 		}
@@ -85,6 +87,7 @@ void UFuelComponent::SetFuelConsumeRate(float inRate)
 	if (GetOwner()->HasAuthority())
 	{
 		mTickRate = inRate > 0.f ? inRate : 0.f;
+		MARK_INVENTORY_PROPERTY_DIRTY(UFuelComponent, mTickRate);
 		if (inRate <= 0.f)
 		{
 			mTimerTick = 1.f;
@@ -141,6 +144,7 @@ bool UFuelComponent::StopFuelSystem()
 			GetWorld()->GetTimerManager().PauseTimer(mFuelTimer);
 		OnFuelSystemToggled.Broadcast(false);
 		bIsRunning = false;
+		MARK_INVENTORY_PROPERTY_DIRTY(UFuelComponent, bIsRunning);
 		return true;
 	}
 	return false;
@@ -169,11 +173,13 @@ bool UFuelComponent::RemoveFuel()
 		if (itemsRemoved > 0)
 		{
 			mCurrentFuelItem = fuelItem;
+			MARK_INVENTORY_PROPERTY_DIRTY(UFuelComponent, mCurrentFuelItem);
 			if (IsValid(mCurrentFuelItem.ItemAsset))
 			{
 				const FStFuelData fuelData = mCurrentFuelItem;
 				const FTimespan fuelTime = FTimespan(fuelData.burnTime);
 				mTimeRemaining = fuelTime.GetTotalSeconds();
+				MARK_INVENTORY_PROPERTY_DIRTY(UFuelComponent, mTimeRemaining);
 				return true;
 			}
 			OnFuelUpdated.Broadcast();
@@ -220,12 +226,14 @@ void UFuelComponent::SetFuelInventory(UInventoryComponent* fuelInv)
 {
 	if (IsValid(fuelInv)) mInventoryFuel = fuelInv;
 	else mInventoryFuel = nullptr;
+	MARK_INVENTORY_PROPERTY_DIRTY(UFuelComponent, mInventoryFuel);
 }
 
 void UFuelComponent::SetOutputInventory(UInventoryComponent* staticInv)
 {
 	if (IsValid(staticInv)) mInventoryStatic = staticInv;
 	else mInventoryStatic = nullptr;
+	MARK_INVENTORY_PROPERTY_DIRTY(UFuelComponent, mInventoryStatic);
 }
 
 
@@ -268,6 +276,7 @@ void UFuelComponent::BeginPlay()
 
 void UFuelComponent::CheckForConsumption()
 {
+	INVENTORY_SCOPE_CYCLE_COUNTER(STAT_InventoryFuelConsumption);
 	if (GetOwner()->HasAuthority())
 	{
 		bool runSystem = true;
@@ -279,6 +288,7 @@ void UFuelComponent::CheckForConsumption()
 			if (bIsRunning)
 			{
 				mTimeRemaining -= 1.f;
+				MARK_INVENTORY_PROPERTY_DIRTY(UFuelComponent, mTimeRemaining);
 				if (mTimeRemaining <= 0.f)
 					CreateByProduct(isOverflowing);
 			}
@@ -287,6 +297,8 @@ void UFuelComponent::CheckForConsumption()
 			{
 				mTimeRemaining = 0.f;
 				mCurrentFuelItem = FStFuelData();
+				MARK_INVENTORY_PROPERTY_DIRTY(UFuelComponent, mTimeRemaining);
+				MARK_INVENTORY_PROPERTY_DIRTY(UFuelComponent, mCurrentFuelItem);
 				runSystem = !isOverflowing && IsReserveFuelAvailable();
 				if (runSystem)
 					runSystem = ConsumeQueuedItem();
@@ -300,6 +312,7 @@ void UFuelComponent::CheckForConsumption()
 		else if (!bIsRunning && runSystem)
 		{
 			bIsRunning = true;
+			MARK_INVENTORY_PROPERTY_DIRTY(UFuelComponent, bIsRunning);
 			OnFuelSystemToggled.Broadcast(true);
 		}
 		
@@ -330,7 +343,7 @@ void UFuelComponent::CreateByProduct(bool &isOverflowing)
 				const int byMin = byProduct.MinimumQuantity > 0 ? byProduct.MinimumQuantity : 1;
 				const int byMax = byProduct.MaximumQuantity < byProduct.MinimumQuantity ? byProduct.MinimumQuantity : byProduct.MaximumQuantity;
 				const int randQuantity = FMath::RandRange(byMin, byMax);
-				mInventoryStatic->AddItemFromDataAsset(byProduct.Data, randQuantity,-1,true,true,true);
+				mInventoryStatic->AddItemFromDataAsset(byProduct.ItemAsset, randQuantity,-1,true,true,true);
 			}
 			else
 			{
@@ -349,8 +362,7 @@ void UFuelComponent::CreateByProduct(bool &isOverflowing)
 					const int byMin = byProduct.MinimumQuantity > 0 ? byProduct.MinimumQuantity : 1;
 					const int byMax = byProduct.MaximumQuantity < byProduct.MinimumQuantity ? byProduct.MinimumQuantity : byProduct.MaximumQuantity;
 					const int randQuantity = FMath::RandRange(byMin, byMax);
-					FStItemData TempItem(byProduct, randQuantity);
-					pickupItem->SetupItem(TempItem);
+					pickupItem->SetupItem(FItemStatics(byProduct.ItemAsset), randQuantity);
 					pickupItem->FinishSpawning(spawnTransform);
 				}
 			}
@@ -363,10 +375,19 @@ void UFuelComponent::CreateByProduct(bool &isOverflowing)
 void UFuelComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
-	DOREPLIFETIME(UFuelComponent, mCurrentFuelItem);
-	DOREPLIFETIME(UFuelComponent, mTimeRemaining);
-	DOREPLIFETIME(UFuelComponent, mTickRate);
-	DOREPLIFETIME(UFuelComponent, mInventoryStatic);
-	DOREPLIFETIME(UFuelComponent, mInventoryFuel);
-	DOREPLIFETIME(UFuelComponent, bIsRunning);
+
+	FDoRepLifetimeParams PushParams;
+	PushParams.bIsPushBased = true;
+	DOREPLIFETIME_WITH_PARAMS_FAST(UFuelComponent, mCurrentFuelItem, PushParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UFuelComponent, mTimeRemaining, PushParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UFuelComponent, mTickRate, PushParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UFuelComponent, mInventoryStatic, PushParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UFuelComponent, mInventoryFuel, PushParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UFuelComponent, bIsRunning, PushParams);
+}
+
+void UFuelComponent::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+	Super::PreReplication(ChangedPropertyTracker);
+	COUNT_INVENTORY_PUSH_COMPARES_AVOIDED(NumPushProperties);
 }
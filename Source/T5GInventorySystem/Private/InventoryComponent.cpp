@@ -2,37 +2,118 @@
 // ReSharper disable CppUE4CodingStandardNamingViolationWarning
 #include "InventoryComponent.h"
 
+#include "InventoryLog.h"
+#include "InventoryPersistenceSubsystem.h"
+#include "InventoryStats.h"
 #include "InventorySystemGlobals.h"
+#include "InventoryTransaction.h"
 #include "PickupActorBase.h"
 #include "GameFramework/Character.h"
 #include "GameFramework/PlayerState.h"
+#include "Algo/BinarySearch.h"
+#include "Async/Async.h"
+#include "Engine/AssetManager.h"
+#include "Engine/NetConnection.h"
 #include "Kismet/GameplayStatics.h"
 #include "lib/InventoryData.h"
 #include "lib/InventorySave.h"
 #include "lib/ItemData.h"
-#include "Logging/StructuredLog.h"
 #include "Net/UnrealNetwork.h" // Used for replication
+#include "TimerManager.h"
 
 
-void UInventoryComponent::Helper_SaveInventory(USaveGame*& SaveData) const
+void UInventoryComponent::Helper_TakeSlotSnapshot(TArray<FInventorySlotSnapshot>& OutSnapshot)
 {
-	UInventorySave* InventorySave = Cast<UInventorySave>( SaveData );
-	if (IsValid(SaveData))
+	FRWScopeLock ReadLock(InventoryMutex, SLT_ReadOnly);
+	OutSnapshot.SetNum(InventorySlots_.Num());
+	for (int i = 0; i < InventorySlots_.Num(); i++)
+	{
+		const FInventorySlotData& InventorySlot = InventorySlots_[i];
+		OutSnapshot[i].ItemStatics	= InventorySlot.ItemStatics;
+		OutSnapshot[i].Quantity		= InventorySlot.Quantity;
+		OutSnapshot[i].SlotTag		= InventorySlot.SlotTag;
+		OutSnapshot[i].SlotFlags	= InventorySlot.SlotFlags;
+	}
+}
+
+static void CopySlotToSave(const FInventorySlotData& InventorySlot, FInventorySlotSaveData& OutSaveSlot)
+{
+	OutSaveSlot.Quantity			= InventorySlot.Quantity;
+	OutSaveSlot.SavedItemStatics	= InventorySlot.ItemStatics;
+	OutSaveSlot.SavedAssetId		= InventorySlot.GetPrimaryAssetId();
+	OutSaveSlot.SavedSlotTags		= InventorySlot.GetSlotTags();
+}
+
+void UInventoryComponent::Helper_GetSaveSlots(TArray<FInventorySlotSaveData>& OutSaveSlots) const
+{
+	OutSaveSlots.SetNum(InventorySlots_.Num());
+	for (int i = 0; i < InventorySlots_.Num(); i++)
+	{
+		CopySlotToSave(InventorySlots_[i], OutSaveSlots[i]);
+	}
+}
+
+const FString& UInventoryComponent::Helper_GetPersistenceId()
+{
+	// A GUID is unique without having to probe the disk for existing saves
+	if (SaveSlotName_.IsEmpty())
+	{
+		SaveSlotName_ = FGuid::NewGuid().ToString(EGuidFormats::Digits);
+	}
+	return SaveSlotName_;
+}
+
+bool UInventoryComponent::Helper_GetPersistenceRecord(FInventoryStoreRecord& OutRecord, int MaxDeltaRecords)
+{
+	bPersistenceDirty_ = false;
+	OutRecord.InventoryId = Helper_GetPersistenceId();
+	OutRecord.bFullRecord = bPersistFullRecord_ || PersistedDeltas_ >= MaxDeltaRecords;
+	if (OutRecord.bFullRecord)
 	{
-		TArray<FInventorySlotSaveData> InventorySaveSlots;
-		TArray<UInventorySlot*> InventorySlots = GetAllInventorySlots();
-		for (int i = 0; i < InventorySlots.Num(); i++)
+		Helper_GetSaveSlots(OutRecord.InventorySlots);
+		PersistedDeltas_ = 0;
+	}
+	else
+	{
+		// Only the slots that changed since the last record
+		for (int i = 0; i < SlotGenerations_.Num(); i++)
 		{
-			UInventorySlot* inventorySlot = InventorySlots[i];
-			if (IsValid(inventorySlot))
-			{
-				InventorySaveSlots[i].Quantity			= inventorySlot->GetQuantity();
-				InventorySaveSlots[i].SavedItemStatics	= inventorySlot->GetItemStatics();
-				InventorySaveSlots[i].SavedAssetId		= inventorySlot->GetPrimaryAssetId();
-				InventorySaveSlots[i].SavedSlotTags		= inventorySlot->GetSlotTags();
-			}
+			if (SlotGenerations_[i] <= PersistedGeneration_) { continue; }
+			CopySlotToSave(InventorySlots_[i], OutRecord.InventorySlots.AddDefaulted_GetRef());
+			OutRecord.SlotNumbers.Add(i);
 		}
-		InventorySave->SavedInventorySlots = InventorySaveSlots;
+		if (OutRecord.SlotNumbers.IsEmpty()) { return false; }
+		++PersistedDeltas_;
+	}
+	PersistedGeneration_	= SlotGeneration_;
+	bPersistFullRecord_		= false;
+	return true;
+}
+
+void UInventoryComponent::Helper_PersistenceFailed()
+{
+	bPersistFullRecord_ = true;
+	Helper_MarkPersistenceDirty();
+}
+
+void UInventoryComponent::Helper_ResetSlotGenerations()
+{
+	SlotGenerations_.Init(0, InventorySlots_.Num());
+	SlotGeneration_			= 0;
+	PersistedGeneration_	= 0;
+	bPersistFullRecord_		= true;
+}
+
+void UInventoryComponent::Helper_MarkPersistenceDirty()
+{
+	if (!bUsePersistenceService || bPersistenceDirty_ || !HasAuthority()) { return; }
+	const UWorld* World = GetWorld();
+	UInventoryPersistenceSubsystem* PersistenceService = IsValid(World)
+		? World->GetSubsystem<UInventoryPersistenceSubsystem>() : nullptr;
+	if (IsValid(PersistenceService))
+	{
+		PersistenceService->MarkInventoryDirty(this);
+		bPersistenceDirty_ = true;
 	}
 }
 
@@ -41,13 +122,50 @@ void UInventoryComponent::BeginPlay()
     Super::BeginPlay();
 	ReinitializeInventory();
 	IssueStartingItems();
-	bInventoryReady = true;
+	Helper_PreloadSlotAssets(true);
+}
+
+void UInventoryComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (bPersistenceDirty_)
+	{
+		const UWorld* World = GetWorld();
+		UInventoryPersistenceSubsystem* PersistenceService = IsValid(World)
+			? World->GetSubsystem<UInventoryPersistenceSubsystem>() : nullptr;
+		if (IsValid(PersistenceService))
+		{
+			PersistenceService->ReleaseInventory(this);
+		}
+	}
+	Super::EndPlay(EndPlayReason);
 }
 
 UInventoryComponent::UInventoryComponent()
 {
     PrimaryComponentTick.bCanEverTick = false;
     SetIsReplicatedByDefault(true);
+	InventorySlots_.Owner = this;
+}
+
+
+void UInventoryComponent::PostInitProperties()
+{
+	Super::PostInitProperties();
+	InventorySlots_.Owner = this;
+}
+
+
+void UInventoryComponent::PostDuplicate(bool bDuplicateForPIE)
+{
+	Super::PostDuplicate(bDuplicateForPIE);
+	InventorySlots_.Owner = this;
+}
+
+
+void UInventoryComponent::OnRegister()
+{
+	Super::OnRegister();
+	InventorySlots_.Owner = this;
 }
 
 
@@ -72,59 +190,55 @@ void UInventoryComponent::ReinitializeInventory()
 	ACharacter* OwnerCharacter = Cast<ACharacter>( GetOwner() );
 	if (!IsValid(OwnerCharacter))
 	{
-		UE_LOGFMT(LogTemp, Error, "{Name}({Authority}): "
+		UE_LOGFMT(LogInventory, Error, "{Name}({Authority}): "
 			"UInventoryComponent is only valid when owned by ACharacter",
 			GetName(), HasAuthority()?"SRV":"CLI");
 		return;
 	}
 
+	// Clients receive the slot layout through replication. Building it locally
+	// would leave unreplicated entries in the fast array next to the server's.
+	if (!HasAuthority()) { return; }
+
 	{
 		FRWScopeLock WriteLock(InventoryMutex, SLT_Write);
 	
-		InventorySlots_.Empty(); // Reset the Inventory Slots
+		InventorySlots_.Items.Empty(); // Reset the Inventory Slots
+		SlotObjects_.Empty();    // Slot views are recreated on demand
+		ItemIndex_.Empty();      // Every slot starts out empty
 		Notifications_.Empty();  // Clear any pending notifications
+		MARK_INVENTORY_PROPERTY_DIRTY(UInventoryComponent, Notifications_);
 	
 		// Set up Inventory Slots
 		if (IsValid(InventoryDataAsset))
 		{
 			const FGameplayTag DefaultInventoryTag = TAG_Inventory_Slot_Generic.GetTag();
+			InventorySlots_.Items.Reserve(
+				InventoryDataAsset->NumberOfInventorySlots + InventoryDataAsset->EquipmentSlots.Num());
 
 			int SlotNumber = 0;
 			for (; SlotNumber < InventoryDataAsset->NumberOfInventorySlots; SlotNumber++)
 			{
-				UInventorySlot* NewInventorySlot = NewObject<UInventorySlot>(this);
-				NewInventorySlot->AddInventorySlotTag(DefaultInventoryTag);
-				NewInventorySlot->InitializeSlot(this, SlotNumber);
-				NewInventorySlot->OnSlotUpdated.AddDynamic(this, &UInventoryComponent::NotifySlotUpdated);
-				InventorySlots_.Add(NewInventorySlot);
+				InventorySlots_.Items.Emplace(SlotNumber, DefaultInventoryTag, EInventorySlotFlags::None);
 			}
 
 			// Adds the equipment slots to the end of the inventory
 			for (const FGameplayTag& NewEquipmentTag : InventoryDataAsset->EquipmentSlots)
 			{
-				UInventorySlot* NewEquipmentSlot = NewObject<UInventorySlot>(this);
-				NewEquipmentSlot->AddInventorySlotTag(TAG_Inventory_Slot_Equipment);
-				NewEquipmentSlot->AddInventorySlotTag(NewEquipmentTag);
-				NewEquipmentSlot->InitializeSlot(this, SlotNumber);
-				NewEquipmentSlot->OnSlotUpdated.AddDynamic(this, &UInventoryComponent::NotifySlotUpdated);
-				InventorySlots_.Add(NewEquipmentSlot);
-				
-				// Set the O(1) variables for combat slots
-				MapEquipmentSlot(NewEquipmentTag, SlotNumber);
-				if (NewEquipmentTag == TAG_Equipment_Slot_Primary)
-					{ PrimarySlot_  	= SlotNumber; }
-				else if (NewEquipmentTag == TAG_Equipment_Slot_Secondary)
-					{ SecondarySlot_	= SlotNumber; }
-				else if (NewEquipmentTag == TAG_Equipment_Slot_Ranged)
-					{ RangedSlot_		= SlotNumber; }
-				else if (NewEquipmentTag == TAG_Equipment_Slot_Ammunition)
-					{ AmmunitionSlot_	= SlotNumber; }
-				
+				InventorySlots_.Items.Emplace(SlotNumber, NewEquipmentTag, EInventorySlotFlags::Equipment);
 				SlotNumber++;
 			}
 		}
+		Helper_UpdateSlotPartition();
+		Helper_RebuildEquipmentSlotMap();
+		Helper_RebuildSlotOccupancy();
+		Helper_RebuildWeight();
+		Helper_ResetSlotGenerations();
+		InventorySlots_.MarkArrayDirty();
+		MARK_INVENTORY_PROPERTY_DIRTY(UInventoryComponent, InventorySlots_);
 	}
-	UE_LOGFMT(LogTemp, Display, "{Name}({Authority}): (Re)Initialized. "
+	Helper_BroadcastPendingSlotChanges();
+	INVENTORY_DEBUG_LOG(bShowDebug, Display, "{Name}({Authority}): (Re)Initialized. "
 		"Inventory has {NumSlots} Slots, of which {NumEquip} are equipment slots.",
 		OwnerCharacter->GetName(), HasAuthority()?"SRV":"CLI",
 		GetNumberOfTotalSlots(), GetNumberOfEquipmentSlots());
@@ -138,26 +252,19 @@ void UInventoryComponent::IssueStartingItems()
 	// Add starting items to the inventory
 	if (IsValid(InventoryDataAsset))
 	{
-		TArray<FStItemData> StartingItems = InventoryDataAsset->GetStartingItems();
-		for (const FStItemData& StartingItem : StartingItems)
+		TArray<FItemStatics> StartingItems = InventoryDataAsset->GetStartingItems(bShowDebug);
+		for (FItemStatics& NewItem : StartingItems)
 		{
-			// Create the item by building a struct
-			FItemStatics NewItem(StartingItem);
-			
 			// Assume that we're putting this item in the first eligible slot
+			// The statics are added as they were generated (AddItemFromDataAsset would create a whole new item)
 			int SlotNumber = -1;
-
-			// Create a pseudo slot so the item is added as it was generated
-			//   (AddItemFromDataAsset will create a whole new item)
-			UInventorySlot* PseudoSlot = NewObject<UInventorySlot>(this);
-			PseudoSlot->AddItem(NewItem.ItemName);
-			PseudoSlot->InitializeSlot(this, 0);
 			
-			if (StartingItem.bIsEquipped)
+			if (NewItem.bIsEquipped)
 			{
-				if (StartingItem.GetIsValidEquipmentItem())
+				const UEquipmentDataAsset* EquipmentData = Cast<UEquipmentDataAsset>(NewItem.GetItemData());
+				if (IsValid(EquipmentData))
 				{
-					for (const FGameplayTag EquipSlot : StartingItem.GetValidEquipmentSlots())
+					for (const FGameplayTag& EquipSlot : EquipmentData->EquippableSlots)
 					{
 						if (IsSlotEmptyByTag(EquipSlot))
 						{
@@ -169,7 +276,7 @@ void UInventoryComponent::IssueStartingItems()
 				if (SlotNumber >= 0)
 				{
 					const int itemsAdded = AddItem(
-						PseudoSlot, NewItem.ItemQuantity, SlotNumber,
+						NewItem, 1, SlotNumber,
 						false, false, false);
 
 					if (itemsAdded > 0)
@@ -181,24 +288,25 @@ void UInventoryComponent::IssueStartingItems()
 				}
 				// No eligible equipment slot found, send to inventory slot
 				NewItem.bIsEquipped = false;
+				SlotNumber = -1;
 			}
         	
 			// Item isn't equipped, or all eligible slots were full
-			const int itemsAdded = AddItem(PseudoSlot, NewItem.ItemQuantity,
+			const int itemsAdded = AddItem(NewItem, 1,
 				SlotNumber, false, false, false);
 			
 			if (itemsAdded > 0)
 			{
-				UE_LOGFMT(LogTemp, Display,
+				INVENTORY_DEBUG_LOG(bShowDebug, Display,
 					"{InvName}({Server}): x{Amount} of '{ItemName}' Added to Slot #{SlotNum}",
 					GetName(), HasAuthority()?"SRV":"CLI", itemsAdded,
-					NewItem.Data->GetItemDisplayNameAsString(), SlotNumber);
+					NewItem.ItemName, SlotNumber);
 			}
 			else
 			{
-				UE_LOGFMT(LogTemp, Warning,
+				UE_LOGFMT(LogInventory, Warning,
 					"{InvName}({Server}): Starting Item '{ItemName}' failed to add",
-					GetName(), HasAuthority()?"SRV":"CLI", NewItem.Data->GetItemDisplayNameAsString());
+					GetName(), HasAuthority()?"SRV":"CLI", NewItem.ItemName);
 			}
 			
 		}//For each starting item
@@ -222,55 +330,68 @@ void UInventoryComponent::Client_InventoryRestored_Implementation()
 /**
  *  Restores inventory slots from a save game. Only runs once,
  *  as bRestoredFromSave is set once this is executed to protect game integrity.
+ *  Only the server writes the slots. A client sends the save to the server,
+ *  and receives the restored slots through replication.
  * @param RestoredInventory One-for-one copy of the inventory slots to restore
  */
 void UInventoryComponent::RestoreInventory(
 	const TArray<FInventorySlotSaveData>& RestoredInventory)
 {
+	// Client will receive the restored broadcast when server updates
+	if (!HasAuthority())
+	{
+		bInventoryRestored = true;
+		Server_RestoreSavedInventory(RestoredInventory);
+		return;
+	}
+
 	// Explicit Scope for write-lock
 	{
 		FRWScopeLock WriteLock(InventoryMutex, SLT_Write);
 		bInventoryReady = false;
 
-		InventorySlots_.Empty(RestoredInventory.Num());
-
+		// Every slot is announced as changed, measured against the item it held before
 		for (int i = 0; i < RestoredInventory.Num(); i++)
 		{
-			UInventorySlot* NewSlot = NewObject<UInventorySlot>(this);
-			NewSlot->RestoreInventorySlot(RestoredInventory[i]);
+			PendingSlotBroadcasts_.Emplace(i, IsValidSlotNumber(i) ? InventorySlots_[i].DataAsset : nullptr);
+		}
 
-			// Attempt to restore the inventory slot in the exact same slot as before
-			const int slotNumber = NewSlot->GetSlotNumber();
-			if (InventorySlots_.IsValidIndex(slotNumber))
-			{
-				InventorySlots_[slotNumber] = NewSlot;
-			}
+		// Saves are a one-for-one copy of the slot array, so the index is the slot number.
+		// Slot objects are views by slot number, so the ones the UI holds stay valid.
+		InventorySlots_.Items.SetNum(RestoredInventory.Num());
+		if (SlotObjects_.Num() > RestoredInventory.Num())
+		{
+			SlotObjects_.SetNum(RestoredInventory.Num());
+		}
 
-			// If that fails, just add it where ever and update the slot Number
-			else
-			{
-				InventorySlots_.Add(NewSlot);
-			}
+		for (int i = 0; i < RestoredInventory.Num(); i++)
+		{
+			const FInventorySlotSaveData& SavedSlot = RestoredInventory[i];
+			FInventorySlotData& InventorySlot = InventorySlots_[i];
+			InventorySlot.ItemStatics	= SavedSlot.SavedItemStatics;
+			InventorySlot.Quantity		= SavedSlot.Quantity;
+			InventorySlot.SlotNumber	= i;
+			InventorySlot.SetSlotTags(SavedSlot.SavedSlotTags);
+			InventorySlot.ResolveDataAsset();
 		}
-		bInventoryReady	= true;
+		Helper_UpdateSlotPartition();
+		Helper_RebuildEquipmentSlotMap();
+		Helper_RebuildItemIndex();
+		Helper_RebuildSlotOccupancy();
+		Helper_RebuildWeight();
+		Helper_ResetSlotGenerations();
+		InventorySlots_.MarkArrayDirty();
+		MARK_INVENTORY_PROPERTY_DIRTY(UInventoryComponent, InventorySlots_);
+
+		// Ready again once every restored item has its asset
+		Helper_PreloadSlotAssets(true);
 	}
+	Helper_BroadcastPendingSlotChanges();
 
-	// If restored by the server, send restored notification to owning client
-	if (HasAuthority())
-	{
-		bInventoryRestored = true;
-		if (OnInventoryRestored.IsBound()) { OnInventoryRestored.Broadcast(true); }
-		Client_InventoryRestored();
-	}
-	
-	// If restored by a client, send to the server for update
-	// Client will receive the restored broadcast when server updates
-	else
-	{
-		bInventoryRestored = true;
-		Server_RestoreSavedInventory(RestoredInventory);
-	}
-	
+	// Send restored notification to owning client
+	bInventoryRestored = true;
+	if (OnInventoryRestored.IsBound()) { OnInventoryRestored.Broadcast(true); }
+	Client_InventoryRestored();
 }
 
 /** @brief Saves the inventory by overwriting the old save file.
@@ -282,64 +403,73 @@ void UInventoryComponent::RestoreInventory(
  */
 FString UInventoryComponent::SaveInventory(FString& responseStr, bool isAsync)
 {
+	INVENTORY_SCOPE_CYCLE_COUNTER(STAT_InventorySave);
 	responseStr = "Failed to Save (Inventory Not Ready)";
 
 	// The inventory save file does not exist, if the string is empty.
-	// If so, the script will try to generate one.
-	if (SaveSlotName_.IsEmpty())
+	// If so, generate a unique name for it.
+	if (Helper_GetPersistenceId().IsEmpty())
 	{
-		FString TempSaveName;
-		do
-		{
-			for (int i = 0; i < 18; i++)
-			{
-				TArray RandValues = {
-					FMath::RandRange(48,57), // Numbers 0-9
-					FMath::RandRange(65,90) // Uppercase A-Z
-				};
-				const char RandChar = static_cast<char>
-					(RandValues[FMath::RandRange(0,RandValues.Num()-1)]);
-				TempSaveName.AppendChar(RandChar);
-			}
-		}
-		// Loop until a unique save string has been created
-		while (UGameplayStatics::DoesSaveGameExist(SaveFolder + TempSaveName, 0));
-		SaveSlotName_ = TempSaveName;
+		responseStr = "Failed to Generate Unique SaveSlotName";
+		return FString();
 	}
 
-	// If still empty, there was a problem with the save slot name
-	if (SaveSlotName_.IsEmpty())
+	// The persistence service writes the inventory with its next batch
+	if (bUsePersistenceService)
 	{
-		responseStr = "Failed to Generate Unique SaveSlotName";
-		return FString();
+		bPersistenceDirty_ = false;
+		Helper_MarkPersistenceDirty();
+		responseStr = bPersistenceDirty_ ? "Queued for Batched Save" : "Failed to Save (No Persistence Service)";
+		return bPersistenceDirty_ ? SaveSlotName_ : FString();
 	}
 
-	USaveGame* SaveData = UGameplayStatics::CreateSaveGameObject( UInventorySave::StaticClass() );
-	if (!IsValid(SaveData))
+	// The game thread only copies the slots. Encoding happens on a worker, and the
+	// save object, which only wraps the encoded bytes, is written by the async save task.
+	TArray<FInventorySlotSnapshot> Snapshot;
+	Helper_TakeSlotSnapshot(Snapshot);
+	const EInventorySaveCompression Compression = IsValid(InventoryDataAsset)
+		? InventoryDataAsset->SaveCompression : EInventorySaveCompression::None;
+
+	if (isAsync)
 	{
-		responseStr = "Failed to Create New Save Object";
-		return FString();
+		Async(EAsyncExecution::ThreadPool,
+			[WeakThis = TWeakObjectPtr<UInventoryComponent>(this), Snapshot = MoveTemp(Snapshot),
+			 SavePath = GetFullSavePath(), UserIndex = GetSaveUserIndex(), Compression]()
+			{
+				TArray<uint8> CompactSlots;
+				UInventorySave::EncodeSlotSnapshot(Snapshot, CompactSlots, Compression);
+				AsyncTask(ENamedThreads::GameThread,
+					[WeakThis, CompactSlots = MoveTemp(CompactSlots), SavePath, UserIndex]() mutable
+					{
+						UInventoryComponent* Inventory = WeakThis.Get();
+						if (!IsValid(Inventory)) { return; }
+						UInventorySave* InventorySave = Cast<UInventorySave>(
+							UGameplayStatics::CreateSaveGameObject( UInventorySave::StaticClass() ));
+						if (!IsValid(InventorySave))
+						{
+							Inventory->SaveInventoryDelegate(SavePath, UserIndex, false);
+							return;
+						}
+						InventorySave->CompactInventorySlots = MoveTemp(CompactSlots);
+
+						FAsyncSaveGameToSlotDelegate SaveDelegate;
+						SaveDelegate.BindUObject(Inventory, &UInventoryComponent::SaveInventoryDelegate);
+						UGameplayStatics::AsyncSaveGameToSlot(InventorySave, SavePath, UserIndex, SaveDelegate);
+					});
+			});
+		responseStr = "Sent Request for Async Save";
+		return SaveSlotName_;
 	}
-	UInventorySave* InventorySave = Cast<UInventorySave>(SaveData);
 
+	UInventorySave* InventorySave = Cast<UInventorySave>(
+		UGameplayStatics::CreateSaveGameObject( UInventorySave::StaticClass() ));
 	if (IsValid(InventorySave))
 	{
-		Helper_SaveInventory(SaveData);
-
-		if (isAsync)
-		{
-			FAsyncSaveGameToSlotDelegate SaveDelegate;
-			SaveDelegate.BindUObject(this, &UInventoryComponent::SaveInventoryDelegate);
-			UGameplayStatics::AsyncSaveGameToSlot(InventorySave,
-					GetFullSavePath(), GetSaveUserIndex(), SaveDelegate);
-			responseStr = "Sent Request for Async Save";
-			return SaveSlotName_;
-		}
-
+		UInventorySave::EncodeSlotSnapshot(Snapshot, InventorySave->CompactInventorySlots, Compression);
 		if (UGameplayStatics::SaveGameToSlot(InventorySave, GetFullSavePath(), GetSaveUserIndex()))
 		{
 			responseStr = "Successful Synchronous Save";
-			UE_LOGFMT(LogTemp, Log, "{InventoryName}({Sv}): "
+			INVENTORY_DEBUG_LOG(bShowDebug, Log, "{InventoryName}({Sv}): "
 				"Successfully Saved Inventory '{InventorySave} ({OwnerName})",
 				GetName(), HasAuthority()?"SRV":"CLI", SaveSlotName_, GetOwner()->GetName());
 			return SaveSlotName_;
@@ -362,16 +492,9 @@ FString UInventoryComponent::GetInventorySaveName() const
  */
 bool UInventoryComponent::CheckIfSameSlot(const UInventorySlot* ComparisonSlot, const int SlotNumber) const
 {
-	if (IsValid(ComparisonSlot) && IsValid(ComparisonSlot->GetParentInventory()))
+	if (IsValid(ComparisonSlot) && ComparisonSlot->GetParentInventory() == this)
 	{
-		if (ComparisonSlot->GetSlotNumber() >= 0)
-		{
-			if (ComparisonSlot->GetParentInventory() == this)
-			{
-				const UInventorySlot* thisSlot = GetInventorySlot(SlotNumber);
-				return ComparisonSlot == thisSlot;
-			}
-		}
+		return IsValidSlotNumber(SlotNumber) && ComparisonSlot->GetSlotNumber() == SlotNumber;
 	}
 	return false;
 }
@@ -388,6 +511,7 @@ bool UInventoryComponent::CheckIfSameSlot(const UInventorySlot* ComparisonSlot,
 bool UInventoryComponent::LoadInventory(
 		FString& responseStr, FString SaveSlotName, int32 SaveUserIndex, bool isAsync)
 {
+	INVENTORY_SCOPE_CYCLE_COUNTER(STAT_InventoryLoad);
 	responseStr = "Failed to Load (Inventory Has Not Initialized)";
 	const bool bHasAuthority = HasAuthority();
 	if ( bHasAuthority && !bSavesOnServer )
@@ -406,6 +530,23 @@ bool UInventoryComponent::LoadInventory(
 		return false;
 	}
 	
+	if (bInventoryReady && bUsePersistenceService)
+	{
+		const UWorld* World = GetWorld();
+		UInventoryPersistenceSubsystem* PersistenceService = IsValid(World)
+			? World->GetSubsystem<UInventoryPersistenceSubsystem>() : nullptr;
+		TArray<FInventorySlotSaveData> RestoredSlots;
+		if (!IsValid(PersistenceService) || !PersistenceService->LoadInventorySlots(SaveSlotName, RestoredSlots))
+		{
+			responseStr = "No Stored Inventory Exists";
+			return false;
+		}
+		SaveSlotName_ = SaveSlotName;
+		RestoreInventory(RestoredSlots);
+		responseStr = "Restored from Persistence Service";
+		return true;
+	}
+
 	if (bInventoryReady)
 	{
 		if (!UGameplayStatics::DoesSaveGameExist(SaveFolder + SaveSlotName, SaveUserIndex_))
@@ -444,12 +585,12 @@ int UInventoryComponent::GetNumberOfTotalSlots() const
 
 int UInventoryComponent::GetNumberOfInventorySlots() const
 {
-	return GetAllInventorySlots().Num();
+	return EquipmentSlotsStart_;
 }
 
 int UInventoryComponent::GetNumberOfEquipmentSlots() const
 {
-	return GetAllEquipmentSlots().Num();
+	return InventorySlots_.Num() - EquipmentSlotsStart_;
 }
 
 /**
@@ -459,7 +600,7 @@ int UInventoryComponent::GetNumberOfEquipmentSlots() const
  */
 FGameplayTagContainer UInventoryComponent::GetSlotInventoryTags(int SlotNumber) const
 {
-	return GetInventorySlot(SlotNumber)->GetSlotTags();
+	return GetSlotData(SlotNumber).GetSlotTags();
 }
 
 /**
@@ -487,34 +628,31 @@ FGameplayTag UInventoryComponent::GetSlotEquipmentTag(int SlotNumber) const
  */
 int UInventoryComponent::GetTotalQuantityByItem(const FName& ItemName) const
 {
-	UE_LOGFMT(LogTemp, Display, "{Inventory}({Sv}): GetTotalQuantityByItem({ItemName})",
+	INVENTORY_DEBUG_LOG(bShowDebug, Display, "{Inventory}({Sv}): GetTotalQuantityByItem({ItemName})",
 		GetName(), HasAuthority()?"SRV":"CLI", ItemName);
 
-    int total = 0;
-    for (const UInventorySlot* InventorySlot : GetAllSlots())
-    {
-    	if (InventorySlot->ContainsItem(ItemName))
-    	{
-			total += InventorySlot->GetQuantity();
-        }
-    }
-    return total;
+	const FInventoryItemIndexEntry* IndexEntry = ItemIndex_.Find(ItemName);
+    return IndexEntry != nullptr ? IndexEntry->TotalQuantity : 0;
 }
 
 /**
- * Returns the SlotNumber of the first empty slot found in the inventory.
+ * Returns the SlotNumber of the first empty slot found in the inventory, sans equipment.
  * @return The SlotNumber of the first empty slot. Negative indicates full inventory.
  */
 int UInventoryComponent::GetFirstEmptySlotNumber() const
 {
-    for (const UInventorySlot* InventorySlot : GetAllSlots())
-    {
-        if (InventorySlot->IsEmpty())
-        {
-	        return InventorySlot->GetSlotNumber();
-        }
-    }
-    return -1;
+	const int FirstEmptySlot = EmptyInventorySlots_.Find(true);
+    return FirstEmptySlot != INDEX_NONE ? FirstEmptySlot : -1;
+}
+
+/**
+ * Returns how many slots are currently empty.
+ * @param bEquipmentSlots If true, counts empty equipment slots instead of inventory slots
+ * @return The number of empty slots
+ */
+int UInventoryComponent::GetNumberOfEmptySlots(bool bEquipmentSlots) const
+{
+	return bEquipmentSlots ? NumEmptyEquipmentSlots_ : NumEmptyInventorySlots_;
 }
 
 /**
@@ -523,28 +661,26 @@ int UInventoryComponent::GetFirstEmptySlotNumber() const
  */
 float UInventoryComponent::GetTotalWeightOfInventorySlots() const
 {
-	float totalWeight = 0.0f;
-	const TArray<UInventorySlot*> allSlots = GetAllSlots();
-	for (int i = 0; i < allSlots.Num(); ++i)
-	{
-		totalWeight += GetWeightOfSlotNumber(i);
-	}
-	return totalWeight;
+	return InventoryWeight_;
 }
 
 /**
- * Returns the total weight of all items in the inventory, sans equipment.
- * @return Float containing the total weight of the inventory. Unitless.
+ * Returns the total weight of all items in the equipment slots.
+ * @return Float containing the total weight of the equipment. Unitless.
  */
 float UInventoryComponent::GetTotalWeightOfEquipmentSlots() const
 {
-	float totalWeight = 0.0f;
-	const TArray<UInventorySlot*> equipmentSlots = GetAllEquipmentSlots();
-	for (int i = 0; i < equipmentSlots.Num(); ++i)
-	{
-		totalWeight += GetWeightOfSlotNumber(i);
-	}
-	return totalWeight;
+	return EquipmentWeight_;
+}
+
+/**
+ * Returns the total weight of everything carried, inventory and equipment.
+ * This is a cached value, so it's cheap enough to query every frame.
+ * @return Float containing the total carry weight. Unitless.
+ */
+float UInventoryComponent::GetTotalWeight() const
+{
+	return InventoryWeight_ + EquipmentWeight_;
 }
 
 /**
@@ -554,8 +690,7 @@ float UInventoryComponent::GetTotalWeightOfEquipmentSlots() const
  */
 float UInventoryComponent::GetWeightOfSlotNumber(int SlotNumber) const
 {
-    const UInventorySlot* InventorySlot = GetInventorySlot(SlotNumber);
-	return IsValid(InventorySlot) ? InventorySlot->GetCarryWeight() : ITEM_WEIGHT_EMPTY;
+	return IsValidSlotNumber(SlotNumber) ? InventorySlots_[SlotNumber].GetCarryWeight() : ITEM_WEIGHT_EMPTY;
 }
 
 /**
@@ -568,13 +703,17 @@ TArray<int> UInventoryComponent::GetInventorySlotNumbersContainingItem(
 	const FName& ItemName, const FItemStatics& ItemStatics) const
 {   
     TArray<int> foundSlots = TArray<int>();
-    for (const UInventorySlot* InventorySlot : GetAllSlots())
-    {
-    	if (InventorySlot->ContainsItem(ItemName, ItemStatics))
-    	{
-    		foundSlots.Add(InventorySlot->GetSlotNumber());
-    	}
-    }
+	if (const FInventoryItemIndexEntry* IndexEntry = ItemIndex_.Find(ItemName))
+	{
+		INC_DWORD_STAT_BY(STAT_InventorySlotsScanned, IndexEntry->SlotNumbers.Num());
+		for (const int SlotNumber : IndexEntry->SlotNumbers)
+		{
+			if (InventorySlots_[SlotNumber].ContainsItem(ItemName, ItemStatics))
+			{
+				foundSlots.Add(SlotNumber);
+			}
+		}
+	}
     return foundSlots;
 }
 
@@ -589,27 +728,55 @@ TArray<int> UInventoryComponent::GetEquipmentSlotNumbersContainingItem(
 	const FName& ItemName, const FItemStatics& ItemStatics) const
 {
 	TArray<int> foundSlots = TArray<int>();
-	for (const UInventorySlot* InventorySlot : GetAllEquipmentSlots())
+	if (const FInventoryItemIndexEntry* IndexEntry = ItemIndex_.Find(ItemName))
 	{
-		if (InventorySlot->ContainsItem(ItemName, ItemStatics))
+		INC_DWORD_STAT_BY(STAT_InventorySlotsScanned, IndexEntry->SlotNumbers.Num());
+		for (const int SlotNumber : IndexEntry->SlotNumbers)
 		{
-			foundSlots.Add(InventorySlot->GetSlotNumber());
+			const FInventorySlotData& InventorySlot = InventorySlots_[SlotNumber];
+			if (SlotNumber >= EquipmentSlotsStart_ && InventorySlot.ContainsItem(ItemName, ItemStatics))
+			{
+				foundSlots.Add(SlotNumber);
+			}
 		}
 	}
 	return foundSlots;
 }
 
 /**
- * Returns a pointer that can manipulate the slot 
+ * Returns a pointer that can manipulate the slot. The slot object is a view
+ * on the packed slot data, and is only created the first time it's requested.
  * @param SlotNumber An int representing the inventory slot
  */
-UInventorySlot* UInventoryComponent::GetInventorySlot(int SlotNumber) const
+UInventorySlot* UInventoryComponent::GetInventorySlot(int SlotNumber)
 {
-    if (IsValidSlotNumber(SlotNumber))
+    if (!IsValidSlotNumber(SlotNumber))
     {
-    	return InventorySlots_[SlotNumber];
+    	return nullptr;
     }
-	return nullptr;
+	if (SlotObjects_.Num() < InventorySlots_.Num())
+	{
+		SlotObjects_.SetNum(InventorySlots_.Num());
+	}
+	if (!IsValid(SlotObjects_[SlotNumber]))
+	{
+		UInventorySlot* NewInventorySlot = NewObject<UInventorySlot>(this);
+		NewInventorySlot->InitializeSlot(this, SlotNumber);
+		SlotObjects_[SlotNumber] = NewInventorySlot;
+	}
+	return SlotObjects_[SlotNumber];
+}
+
+
+/**
+ * Read-only access to the packed data of the given slot
+ * @param SlotNumber An int representing the inventory slot
+ * @return The slot data, or an empty slot if the slot number is invalid
+ */
+const FInventorySlotData& UInventoryComponent::GetSlotData(int SlotNumber) const
+{
+	static const FInventorySlotData EmptySlot;
+	return IsValidSlotNumber(SlotNumber) ? InventorySlots_[SlotNumber] : EmptySlot;
 }
 
 
@@ -620,49 +787,121 @@ UInventorySlot* UInventoryComponent::GetInventorySlot(int SlotNumber) const
  */
 int UInventoryComponent::GetSlotNumber(const UInventorySlot* SlotReference) const
 {
-	const TArray InventorySlots = GetAllSlots();
-	for (int i = 0; i < InventorySlots.Num(); i++)
+	if (IsValid(SlotReference) && SlotReference->GetParentInventory() == this)
 	{
-		if (InventorySlots[i] == SlotReference)
-		{
-			return i;
-		}
+		const int SlotNumber = SlotReference->GetSlotNumber();
+		return IsValidSlotNumber(SlotNumber) ? SlotNumber : -1;
 	}
 	return -1;
 }
 
 
-TArray<UInventorySlot*> UInventoryComponent::GetAllSlots() const
+TArrayView<const FInventorySlotData> UInventoryComponent::GetAllSlots() const
+{
+	return InventorySlots_.Items;
+}
+
+
+/**
+ * Inventory slots always precede the equipment slots, so this is the
+ * front of the slot array, up to the stored partition point.
+ */
+TArrayView<const FInventorySlotData> UInventoryComponent::GetAllInventorySlots() const
+{
+	return GetAllSlots().Left(EquipmentSlotsStart_);
+}
+
+
+TArrayView<const FInventorySlotData> UInventoryComponent::GetAllEquipmentSlots() const
+{
+	return GetAllSlots().RightChop(EquipmentSlotsStart_);
+}
+
+
+/**
+ * Recalculates the cached weight totals from scratch. Only needed when the
+ * whole slot array has been replaced; otherwise the totals are updated by delta.
+ */
+void UInventoryComponent::Helper_RebuildWeight()
 {
-	return InventorySlots_;
+	InventoryWeight_ = 0.f;
+	EquipmentWeight_ = 0.f;
+	for (const FInventorySlotData& InventorySlot : GetAllInventorySlots())
+	{
+		InventoryWeight_ += InventorySlot.GetCarryWeight();
+	}
+	for (const FInventorySlotData& EquipmentSlot : GetAllEquipmentSlots())
+	{
+		EquipmentWeight_ += EquipmentSlot.GetCarryWeight();
+	}
 }
 
 
-TArray<UInventorySlot*> UInventoryComponent::GetAllInventorySlots() const
+/**
+ * Broadcasts OnWeightChanged if the total weight has moved across one of the WeightThresholds
+ */
+void UInventoryComponent::Helper_CheckWeightThreshold()
 {
-	TArray<UInventorySlot*> returnArray;
-	for (UInventorySlot* Slot : GetAllSlots())
+	const float TotalWeight = GetTotalWeight();
+	int NewThreshold = 0;
+	for (const float Threshold : WeightThresholds)
+	{
+		if (TotalWeight >= Threshold) { NewThreshold++; }
+	}
+	if (NewThreshold != WeightThreshold_)
 	{
-		if (!Slot->GetIsEquipmentSlot())
+		WeightThreshold_ = NewThreshold;
+		if (OnWeightChanged.IsBound())
 		{
-			returnArray.Add(Slot);
+			OnWeightChanged.Broadcast(TotalWeight, WeightThreshold_);
 		}
 	}
-	return returnArray;
 }
 
 
-TArray<UInventorySlot*> UInventoryComponent::GetAllEquipmentSlots() const
+/**
+ * Maps every equipment slot tag to its slot, and sets the O(1) variables for combat slots.
+ * Called whenever the slot layout changes, after Helper_UpdateSlotPartition.
+ */
+void UInventoryComponent::Helper_RebuildEquipmentSlotMap()
+{
+	TagsMappedToSlots_.Empty();
+	PrimarySlot_	= -1;
+	SecondarySlot_	= -1;
+	RangedSlot_		= -1;
+	AmmunitionSlot_	= -1;
+	for (int SlotNumber = EquipmentSlotsStart_; SlotNumber < InventorySlots_.Num(); SlotNumber++)
+	{
+		const FGameplayTag& EquipmentTag = InventorySlots_[SlotNumber].SlotTag;
+		if (!EquipmentTag.IsValid()) { continue; }
+
+		MapEquipmentSlot(EquipmentTag, SlotNumber);
+		if (EquipmentTag == TAG_Equipment_Slot_Primary)
+			{ PrimarySlot_  	= SlotNumber; }
+		else if (EquipmentTag == TAG_Equipment_Slot_Secondary)
+			{ SecondarySlot_	= SlotNumber; }
+		else if (EquipmentTag == TAG_Equipment_Slot_Ranged)
+			{ RangedSlot_		= SlotNumber; }
+		else if (EquipmentTag == TAG_Equipment_Slot_Ammunition)
+			{ AmmunitionSlot_	= SlotNumber; }
+	}
+}
+
+
+/**
+ * Finds where the equipment slots begin. Called whenever the slot layout changes.
+ */
+void UInventoryComponent::Helper_UpdateSlotPartition()
 {
-	TArray<UInventorySlot*> returnArray;
-	for (UInventorySlot* Slot : GetAllSlots())
+	EquipmentSlotsStart_ = InventorySlots_.Num();
+	for (int i = 0; i < InventorySlots_.Num(); i++)
 	{
-		if (Slot->GetIsEquipmentSlot())
+		if (InventorySlots_[i].GetIsEquipmentSlot())
 		{
-			returnArray.Add(Slot);
+			EquipmentSlotsStart_ = i;
+			break;
 		}
 	}
-	return returnArray;
 }
 
 
@@ -672,6 +911,51 @@ void UInventoryComponent::NotifySlotUpdated(const int SlotNumber)
 	{
 		OnInventoryUpdated.Broadcast(SlotNumber);
 	}
+	Helper_QueueBatchedSlotUpdate(SlotNumber);
+}
+
+
+void UInventoryComponent::Helper_QueueBatchedSlotUpdate(int SlotNumber)
+{
+	if (bBatchSlotUpdates && SlotNumber >= 0)
+	{
+		if (PendingSlotUpdates_.Num() <= SlotNumber)
+		{
+			const int NumSlots = FMath::Max(InventorySlots_.Num(), SlotNumber + 1);
+			PendingSlotUpdates_.Add(false, NumSlots - PendingSlotUpdates_.Num());
+		}
+		PendingSlotUpdates_[SlotNumber] = true;
+		if (!bSlotUpdateFlushPending_ && IsValid(GetWorld()))
+		{
+			bSlotUpdateFlushPending_ = true;
+			GetWorld()->GetTimerManager().SetTimerForNextTick(FTimerDelegate::CreateUObject(
+				this, &UInventoryComponent::FlushSlotUpdates));
+		}
+	}
+}
+
+
+/**
+ * Broadcasts every slot change collected since the last flush in one OnInventoryBatchUpdated.
+ * Runs on the frame after the first change, or earlier when called directly.
+ */
+void UInventoryComponent::FlushSlotUpdates()
+{
+	bSlotUpdateFlushPending_ = false;
+
+	TArray<int> SlotNumbers;
+	for (TConstSetBitIterator<> It(PendingSlotUpdates_); It; ++It)
+	{
+		SlotNumbers.Add(It.GetIndex());
+	}
+	if (SlotNumbers.IsEmpty()) { return; }
+
+	// Cleared before broadcasting, so listeners that change slots start the next batch
+	PendingSlotUpdates_.Init(false, PendingSlotUpdates_.Num());
+	if (OnInventoryBatchUpdated.IsBound())
+	{
+		OnInventoryBatchUpdated.Broadcast(SlotNumbers);
+	}
 }
 
 /**
@@ -690,16 +974,16 @@ int UInventoryComponent::GetSlotNumberByTag(const FGameplayTag& SlotTag) const
     if (SlotTag.MatchesTag(TAG_Equipment_Slot))
     {
         // Loop through until we find the slot since we only have 1 of each
-        for (const UInventorySlot* EquipmentSlot : GetAllEquipmentSlots())
+        for (int i = EquipmentSlotsStart_; i < InventorySlots_.Num(); i++)
         {
-        	if (EquipmentSlot->ContainsTag(SlotTag))
+        	if (InventorySlots_[i].ContainsTag(SlotTag))
         	{
-        		return EquipmentSlot->GetSlotNumber();
+        		return i;
         	}
         }
     }
 	
-	UE_LOGFMT(LogTemp, Warning,
+	UE_LOGFMT(LogInventory, Warning,
 		"{Inventory}({Sv}): No Equipment Slot Exists for Tag '{SlotTag}'",
 		GetName(), HasAuthority()?"SRV":"CLI", TAG_Equipment_Slot.GetTag().ToString());
     return -1;
@@ -714,7 +998,7 @@ FItemStatics UInventoryComponent::GetSlotNumberItem(int SlotNumber) const
 {
 	if (IsValidItemInSlot(SlotNumber))
 	{
-		return GetInventorySlot(SlotNumber)->GetItemStatics();
+		return InventorySlots_[SlotNumber].ItemStatics;
 	}
 	return FItemStatics();
 }
@@ -724,7 +1008,7 @@ const UItemDataAsset* UInventoryComponent::GetSlotNumberItemData(int SlotNumber)
 {
 	if (IsValidItemInSlot(SlotNumber))
 	{
-		return GetInventorySlot(SlotNumber)->GetItemData();
+		return InventorySlots_[SlotNumber].DataAsset;
 	}
 	return nullptr;
 }
@@ -734,7 +1018,7 @@ bool UInventoryComponent::IsValidItemInSlot(int SlotNumber) const
 {
 	if (IsValidSlotNumber(SlotNumber))
 	{
-		return GetInventorySlot(SlotNumber)->ContainsValidItem();
+		return InventorySlots_[SlotNumber].ContainsValidItem();
 	}
 	return false;
 }
@@ -757,7 +1041,7 @@ bool UInventoryComponent::IsValidEquipmentSlot(int SlotNumber) const
 {
 	if (IsValidSlotNumber(SlotNumber))
 	{
-		if (GetInventorySlot(SlotNumber)->ContainsTag(TAG_Equipment_Slot))
+		if (InventorySlots_[SlotNumber].ContainsTag(TAG_Equipment_Slot))
 		{
 			return true;
 		}
@@ -767,9 +1051,9 @@ bool UInventoryComponent::IsValidEquipmentSlot(int SlotNumber) const
 
 bool UInventoryComponent::IsValidSlotByEquipmentTag(const FGameplayTag& SearchTag) const
 {
-	for ( const auto& InventorySlot : GetAllSlots() )
+	for ( const FInventorySlotData& InventorySlot : InventorySlots_ )
 	{
-		if (InventorySlot->ContainsTag(SearchTag))
+		if (InventorySlot.ContainsTag(SearchTag))
 		{
 			return true;
 		}
@@ -809,7 +1093,7 @@ bool UInventoryComponent::IsSlotEmptyByTag(const FGameplayTag& SearchTag)
 int UInventoryComponent::GetQuantityInSlotNumber(int SlotNumber) const
 {
     if (!IsValidSlotNumber(SlotNumber)) { return -1; }
-    const int SlotQuantity = GetInventorySlot(SlotNumber)->GetQuantity();
+    const int SlotQuantity = FMath::Max(InventorySlots_[SlotNumber].Quantity, 0);
     return SlotQuantity;
 }
 
@@ -827,131 +1111,67 @@ int UInventoryComponent::AddItem(const UInventorySlot* SlotReference,
     int OrderQuantity, int SlotNumber, bool bAddOverflow, bool bDropOverflow, bool bNotify)
 {
     // If reference slot is empty, do nothing
-    if (SlotReference->IsEmpty())
+    if (!IsValid(SlotReference) || SlotReference->IsEmpty())
     {
-    	UE_LOGFMT(LogTemp, Display,
+    	INVENTORY_DEBUG_LOG(bShowDebug, Display,
 			"{Inventory}({Sv}): AddItem Failed - Existing Slot is Empty",
 			GetName(), HasAuthority()?"SRV":"CLI");
 	    return -1;
     }
+
+	// Copied, as the reference slot may belong to this inventory and change while adding
+	const FItemStatics NewItem = SlotReference->GetItemStatics();
+	return AddItem(NewItem, OrderQuantity, SlotNumber, bAddOverflow, bDropOverflow, bNotify);
+}
+
+/**
+ * @brief Adds the item to this inventory with the given quantity, without needing a slot to copy from
+ * @param NewItem The statics of the item being added
+ * @param OrderQuantity How many to add
+ * @param SlotNumber The slot to add to. Negative means stack or fill first slot.
+ * @param bAddOverflow If true, add to the next eligible slot if this slot fills up
+ * @param bDropOverflow If true, drop items to ground if slot fills up
+ * @param bNotify If true, notify the player a new item was added
+ * @return The amount of items added. Negative indicates error.
+ */
+int UInventoryComponent::AddItem(const FItemStatics& NewItem,
+    int OrderQuantity, int SlotNumber, bool bAddOverflow, bool bDropOverflow, bool bNotify)
+{
+	INVENTORY_SCOPE_CYCLE_COUNTER(STAT_InventoryAddItem);
+    if (NewItem.ItemName.IsNone())
+    {
+    	INVENTORY_DEBUG_LOG(bShowDebug, Display,
+			"{Inventory}({Sv}): AddItem Failed - Item is not a valid item",
+			GetName(), HasAuthority()?"SRV":"CLI");
+	    return -1;
+    }
 	
-	int itemsAdded = 0;
 	const int StartingQuantity = OrderQuantity > 0 ? OrderQuantity : 1;
     int RemainingQuantity = StartingQuantity;
 
-    // This is a safeguard against an infinite loop
-    int LoopIterations = 0;
-    do
-    {
-        LoopIterations += 1;
-        
-        // If the slot number is invalid, find first stackable or empty slot
-        if (SlotNumber < 0)
-        {
-            // See if a valid existing slot can be stacked
-            if (SlotReference->GetMaxStackAllowance() > 1)
-            {
-            	// Returns a list of slots that have the exact same item
-                TArray MatchingSlots(GetInventorySlotNumbersContainingItem(SlotReference->GetItemName()));
-                for (const auto& ExistingSlotNumber : MatchingSlots)
-                {
-                	if (IsValidSlotNumber(ExistingSlotNumber))
-                	{
-                        const UInventorySlot* MatchingSlot  = GetInventorySlot(ExistingSlotNumber);
-						if (!MatchingSlot->IsFull())
-						{
-							SlotNumber = MatchingSlot->GetSlotNumber();
-						}
-                        
-                    }//valid slot
-                }//existing slots
-            }// is stackable
-            
-            // If no stackable slot is available, add to the first empty slot
-            if (SlotNumber < 0)
-            {
-                const int FirstFreeSlot = GetFirstEmptySlotNumber();
-                if (IsValidSlotNumber(FirstFreeSlot))
-                {
-                    SlotNumber = FirstFreeSlot;
-                }
-            }
-
-        	// If the slot number is still invalid, the inventory is full
-        	if (SlotNumber < 0)
-        	{
-        		UE_LOGFMT(LogTemp, Display, "{Name}({Authority}): AddItem() "
-        			"Failed. The inventory is full.", GetName(), HasAuthority()?"SRV":"CLI");
-				if (!bDropOverflow) { return 0; }
-        		bInventoryFull = true;
-        		break;
-        	}
-        	
-        }// invalid slot number
-
-        // If the slot is now valid (or was valid to start with), add the item
-        if (SlotNumber >= 0)
-        {
-        	FRWScopeLock WriteLock(InventoryMutex, SLT_Write);
-        	
-        	UInventorySlot* ReferenceSlot = GetInventorySlot(SlotNumber);
-        	if (IsValid(ReferenceSlot))
-        	{
-        		// If the slot is empty, set the slot item
-        		if (ReferenceSlot->IsEmpty())
-        		{
-        			itemsAdded += ReferenceSlot->AddItem(ReferenceSlot->GetItemStatics(), OrderQuantity);
-        		}
-				else
-				{
-					// Either adds all the remaining items, or adds as much as it can
-					// Which will be deducted from RemainingQuantity for the next iteration
-					itemsAdded += ReferenceSlot->IncreaseQuantity(RemainingQuantity);
-				}
-        		
-        		// No changes; No items were added
-        		if (itemsAdded <= 0)
-        		{
-        			SlotNumber = -1;
-        		}
-        		// Items were successfully added, or there were none to add
-        		else
-        		{
-        			// If items are still remaining, this stack is full
-        			RemainingQuantity -= itemsAdded;
-        			if (bAddOverflow)
-        			{
-        				SlotNumber = -1;
-        			}
-        		}
-        	}
-        }// valid slot number
-        
-    }
-    // Keep looping so long as there is:
-    while (
-        RemainingQuantity > 0       // There are more items to be added,   AND
-        && bAddOverflow             // Add all overflowing items,          AND
-        && SlotNumber < 0           // No eligible spot has been found,    AND
-        && LoopIterations < 1000    // The loop is not hanging
-        );
-
-    if (LoopIterations >= 1000)
-    {
-        UE_LOGFMT(LogTemp, Error,
-        	"{Inventory}({Sv}): AddItem() - Terminated an Infinite Loop",
-            GetName(), HasAuthority()?"SRV":"CLI");
-        return RemainingQuantity;
-    }
-
-    if (RemainingQuantity > 0 && bDropOverflow)
+	// The placement is planned in one pass and every slot it fills replicates and broadcasts together
+	{
+		FInventoryTransaction Transaction(this);
+		if (Transaction.HasFailed()) { return -1; }
+		const int ItemsAdded = Transaction.AddItem(NewItem, StartingQuantity, SlotNumber, bAddOverflow, false);
+		Transaction.Commit();
+		RemainingQuantity -= FMath::Max(ItemsAdded, 0);
+	}
+
+	if (RemainingQuantity > 0 && bAddOverflow)
+	{
+		INVENTORY_DEBUG_LOG(bShowDebug, Display, "{Name}({Authority}): AddItem() "
+			"Failed. The inventory is full.", GetName(), HasAuthority()?"SRV":"CLI");
+	}
+
+    if (RemainingQuantity > 0 && bDropOverflow)
     {
     	const int ItemsAdded = OrderQuantity - RemainingQuantity;
         const ACharacter* OwnerCharacter = Cast<ACharacter>( GetOwner() );
-        const USkeletalMeshComponent* thisMesh = OwnerCharacter->GetMesh();
+        const USkeletalMeshComponent* thisMesh = IsValid(OwnerCharacter) ? OwnerCharacter->GetMesh() : nullptr;
         if (!IsValid(thisMesh))
         {
-        	UE_LOGFMT(LogTemp, Error,
+        	UE_LOGFMT(LogInventory, Error,
 				"{Inventory}({Sv}): AddItem() - Invalid Mesh. "
 				"Cannot spawn Pick Up actor! {NumStart} Requested. {NumAdded} Added, {NumLeft} Remaining", 
 				GetName(), HasAuthority()?"SRV":"CLI", OrderQuantity, ItemsAdded, RemainingQuantity);
@@ -964,16 +1184,20 @@ int UInventoryComponent::AddItem(const UInventorySlot* SlotReference,
                  FMath::RandRange(0.f,359.f),
                  FMath::RandRange(0.f,359.f)),
             thisMesh->GetBoneLocation("Root"));
-        FActorSpawnParameters spawnParams;
-        spawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
 
-        APickupActorBase* pickupItem = GetWorld()->SpawnActor<APickupActorBase>(
-                                                APickupActorBase::StaticClass(), spawnTransform);
-    	pickupItem->SetupItem(SlotReference->GetItemStatics(), RemainingQuantity);
-        RemainingQuantity = 0;
+        // Deferred, as the pickup only takes its item before BeginPlay
+        APickupActorBase* pickupItem = GetWorld()->SpawnActorDeferred<APickupActorBase>(
+        	APickupActorBase::StaticClass(), spawnTransform, nullptr, nullptr,
+        	ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+    	if (IsValid(pickupItem))
+    	{
+    		pickupItem->SetupItem(NewItem, RemainingQuantity);
+    		pickupItem->FinishSpawning(spawnTransform);
+    		RemainingQuantity = 0;
+    	}
     }
 	
-	UE_LOGFMT(LogTemp, Display,
+	INVENTORY_DEBUG_LOG(bShowDebug, Display,
 		"{Inventory}({Sv}): AddItem() Finished - {NumStart} Requested."
 		"{NumAdded} Added, {NumRemain} Remaining",
 		GetName(), HasAuthority()?"SRV":"CLI", OrderQuantity, OrderQuantity - RemainingQuantity, RemainingQuantity);
@@ -984,7 +1208,7 @@ int UInventoryComponent::AddItem(const UInventorySlot* SlotReference,
 
 /**
     * @brief Adds the requested item to this inventory with the given quantity.
-    *       Internally calls 'AddItemFromExistingSlot()' by making a pseudo-slot.
+    *       Internally calls 'AddItem()' with new statics for the item.
     * @param ItemDataAsset Item to be added from the data table
     * @param OrderQuantity The total quantity to add
     * @param SlotNumber The slot to add to. Negative means stack or fill first slot.
@@ -999,7 +1223,7 @@ int UInventoryComponent::AddItemFromDataAsset(
 {
     if (!IsValid(ItemDataAsset))
     {
-    	UE_LOGFMT(LogTemp, Display,
+    	INVENTORY_DEBUG_LOG(bShowDebug, Display,
 			"{Inventory}({Sv}): AddItemFromDataTable() - Item '{ItemName}' is not a valid item",
 			GetName(), HasAuthority()?"SRV":"CLI", ItemDataAsset->GetItemDisplayNameAsString());
 	    return -1;
@@ -1018,9 +1242,9 @@ int UInventoryComponent::AddItemFromDataAsset(
 		else
 		{
 			// Slot is Full
-			if (GetInventorySlot(SlotNumber)->IsFull())
+			if (InventorySlots_[SlotNumber].IsFull())
 			{
-				UE_LOGFMT(LogTemp, Warning,
+				UE_LOGFMT(LogInventory, Warning,
 					"{Inventory}({Sv}): AddItem() Failed - Inventory Slot Full",
 					GetName(), HasAuthority()?"SRV":"CLI");
 				return -3;
@@ -1028,25 +1252,20 @@ int UInventoryComponent::AddItemFromDataAsset(
 		}
     }
 
-	// pseudo-slot to simply function operations & avoid repeated code
-	UInventorySlot* PseudoSlot = NewObject<UInventorySlot>(this);
-	PseudoSlot->AddItem( FItemStatics(ItemDataAsset) );
-	PseudoSlot->InitializeSlot(this, 0);
-	
     const int ItemsAdded = AddItem(
-    	PseudoSlot, QuantityToAdd, SlotNumber, bAddOverflow, bDropOverflow, bNotify);
+    	FItemStatics(ItemDataAsset), QuantityToAdd, SlotNumber, bAddOverflow, bDropOverflow, bNotify);
 
 	const int RemainingQuantity = QuantityToAdd - ItemsAdded;
     if (ItemsAdded >= 0)
     {
-    	UE_LOGFMT(LogTemp, Display,
+    	INVENTORY_DEBUG_LOG(bShowDebug, Display,
 			"{Inventory}({Sv}): AddItemFromDataTable() - Finished. "
 			"{NumStart} Requested. {NumAdded} Added, {NumRemain} Remaining",
 			GetName(), HasAuthority()?"SRV":"CLI", OrderQuantity, ItemsAdded, RemainingQuantity);
     }
 	else
 	{
-		UE_LOGFMT(LogTemp, Display,
+		INVENTORY_DEBUG_LOG(bShowDebug, Display,
 			"{Inventory}({Sv}): AddItemFromDataTable() Failed - "
 			"Misfire of internal request to AddItem(). "
 			"{NumStart} Requested. {NumAdded} Added, {NumRemain} Remaining",
@@ -1112,7 +1331,7 @@ int UInventoryComponent::RemoveItemFromSlot(
 {
     if (!GetIsInventorySystemReady())
     {
-	    UE_LOGFMT(LogTemp, Error,
+	    UE_LOGFMT(LogInventory, Error,
 			"{Inventory}({Sv}): RemoveItemFromSlot() Failed - Inventory Not Ready",
 			GetName(), HasAuthority()?"SRV":"CLI");
     	return -1;
@@ -1120,7 +1339,7 @@ int UInventoryComponent::RemoveItemFromSlot(
 	
     if (!IsValidSlotNumber(OriginSlotNumber))
     {
-	    UE_LOGFMT(LogTemp, Error,
+	    UE_LOGFMT(LogInventory, Error,
 			"{Inventory}({Sv}): RemoveItemFromSlot() Failed - "
 			"#{SlotNum} is not a valid Slot",
 			GetName(), HasAuthority()?"SRV":"CLI", OriginSlotNumber);
@@ -1129,10 +1348,9 @@ int UInventoryComponent::RemoveItemFromSlot(
 	
 	const int AdjustedQuantity = OrderQuantity > 0 ? OrderQuantity : 1;
 	
-	const UInventorySlot* InventorySlot = GetInventorySlot(OriginSlotNumber);
-	if (InventorySlot->IsEmpty())
+	if (InventorySlots_[OriginSlotNumber].IsEmpty())
 	{
-		UE_LOGFMT(LogTemp, Error,
+		UE_LOGFMT(LogInventory, Error,
 			"{Inventory}({Sv}): RemoveItemFromSlot() Failed - "
 			" #{SlotNum} is EMPTY",
 			GetName(), HasAuthority()?"SRV":"CLI", OriginSlotNumber);
@@ -1152,26 +1370,16 @@ int UInventoryComponent::RemoveItemFromSlot(
 
 	{
 		FRWScopeLock WriteLock(InventoryMutex, SLT_Write);
-
-    	UInventorySlot* SlotReference = GetInventorySlot(OriginSlotNumber);
-
-    	NewQuantity = SlotReference->DecreaseQuantity(RemoveQuantity);
-    	ItemsRemoved = AdjustedQuantity - NewQuantity;
+    	NewQuantity = Helper_SetSlotQuantity(OriginSlotNumber, slotQuantity - RemoveQuantity);
+    	ItemsRemoved = NewQuantity >= 0 ? slotQuantity - NewQuantity : 0;
 	}
+	Helper_BroadcastPendingSlotChanges();
 	
-	UE_LOGFMT(LogTemp, Display,
+	INVENTORY_DEBUG_LOG(bShowDebug, Display,
 		"{Inventory}({Sv}): RemoveItemFromSlot() Finished - "
 		"{StartQty} Requested. {NumRemoved} Actually Removed. New Quantity = {NewQuantity}",
 		GetName(), HasAuthority()?"SRV":"CLI", AdjustedQuantity, ItemsRemoved, NewQuantity);
 	
-	if (bInventoryFull)
-	{
-		// If any items were removed, the inventory is no longer full
-		UE_LOGFMT(LogTemp, Display,
-			"{Inventory}({Sv}): RemoveItemFromSlot() - The inventory is no longer full.",
-			GetName(), HasAuthority()?"SRV":"CLI");
-		bInventoryFull = (ItemsRemoved <= 0);
-	}
 	return ItemsRemoved;
 }
 
@@ -1190,9 +1398,10 @@ int UInventoryComponent::RemoveItemFromSlot(
 int UInventoryComponent::RemoveItemByQuantity(
 	const FItemStatics& ItemReference, int OrderQuantity, bool bRemoveEquipment, bool bDropOnGround, bool bRemoveAll)
 {
+	INVENTORY_SCOPE_CYCLE_COUNTER(STAT_InventoryRemoveItem);
     if (!GetIsInventorySystemReady())
     {
-    	UE_LOGFMT(LogTemp, Warning,
+    	UE_LOGFMT(LogInventory, Warning,
 			"{Inventory}({Sv}): RemoveItemByQuantity() Failed - Inventory Not Ready",
 			GetName(), HasAuthority()?"SRV":"CLI");
 	    return -1;
@@ -1200,7 +1409,7 @@ int UInventoryComponent::RemoveItemByQuantity(
 	
     if (ItemReference.ItemName.IsNone())
     {
-    	UE_LOGFMT(LogTemp, Error,
+    	UE_LOGFMT(LogInventory, Error,
 			"{Inventory}({Sv}): RemoveItemFromSlot() Failed - "
 			"Reference Item is not a valid item.",
 			GetName(), HasAuthority()?"SRV":"CLI");
@@ -1210,32 +1419,73 @@ int UInventoryComponent::RemoveItemByQuantity(
 	const int AdjustedQuantity = OrderQuantity > 0 ? OrderQuantity : 1;
     int RemainingQuantity = AdjustedQuantity; // Track how many we've removed
 
-	FRWScopeLock WriteLock(InventoryMutex, SLT_Write);
-	for (UInventorySlot* SlotReference : InventorySlots_)
 	{
-		if (SlotReference->ContainsItem(ItemReference.ItemName))
+		FInventoryTransaction Transaction(this);
+		if (Transaction.HasFailed()) { return -1; }
+
+		// Copied, since emptying a slot removes it from the index entry
+		TArray<int, TInlineAllocator<4>> MatchingSlots;
+		if (const FInventoryItemIndexEntry* IndexEntry = ItemIndex_.Find(ItemReference.ItemName))
 		{
-			const int itemsRemoved = SlotReference->DecreaseQuantity(AdjustedQuantity);
-			RemainingQuantity -= itemsRemoved;
-			if (RemainingQuantity < 1 || itemsRemoved < 1) { break; }
+			MatchingSlots = IndexEntry->SlotNumbers;
 		}
-    }
+		INC_DWORD_STAT_BY(STAT_InventorySlotsScanned, MatchingSlots.Num());
+		for (const int i : MatchingSlots)
+		{
+			const FInventorySlotData& SlotReference = InventorySlots_[i];
+			if (i >= EquipmentSlotsStart_ && !bRemoveEquipment) { continue; }
+			if (SlotReference.ContainsItem(ItemReference.ItemName))
+			{
+				const int OldQuantity	= SlotReference.Quantity;
+				const int RemoveAmount	= bRemoveAll ? OldQuantity : FMath::Min(OldQuantity, RemainingQuantity);
+				const int NewQuantity	= Helper_SetSlotQuantity(i, OldQuantity - RemoveAmount);
+				if (NewQuantity >= 0) { RemainingQuantity -= OldQuantity - NewQuantity; }
+				if (RemainingQuantity < 1 && !bRemoveAll) { break; }
+			}
+		}
+		Transaction.Commit();
+	}
     
 	const int ItemsRemoved = AdjustedQuantity - RemainingQuantity;
-	UE_LOGFMT(LogTemp, Display,
+	INVENTORY_DEBUG_LOG(bShowDebug, Display,
 		"{Inventory}({Sv}): RemoveItemFromSlot() Finished - "
 		"{NumRequest} Requested. {NumRemoved} Removed, {NumRemain} Remaining",
 		GetName(), HasAuthority()?"SRV":"CLI", OrderQuantity, ItemsRemoved, RemainingQuantity);
 	
-	if (bInventoryFull)
-	{
-		// If any items were removed, the inventory is no longer full
-		UE_LOGFMT(LogTemp, Display,
-			"{Inventory}({Sv}): RemoveItemFromSlot() - The inventory is no longer full.",
+	return ItemsRemoved;
+}
+
+/**
+* Removes several items at once, such as the ingredients of a recipe. Either every
+* item is removed in full, or the inventory is left untouched.
+*
+* @param ItemQuantities The name and quantity of each item to remove
+* @return True if every item was removed
+*/
+bool UInventoryComponent::RemoveItems(const TMap<FName, int>& ItemQuantities)
+{
+	INVENTORY_SCOPE_CYCLE_COUNTER(STAT_InventoryRemoveItem);
+    if (!GetIsInventorySystemReady())
+    {
+    	UE_LOGFMT(LogInventory, Warning,
+			"{Inventory}({Sv}): RemoveItems() Failed - Inventory Not Ready",
 			GetName(), HasAuthority()?"SRV":"CLI");
-		bInventoryFull = (ItemsRemoved <= 0);
+	    return false;
+    }
+
+	FInventoryTransaction Transaction(this);
+	for (const TPair<FName, int>& ItemQuantity : ItemQuantities)
+	{
+		if (Transaction.HasFailed()) { break; }
+		Transaction.RemoveItem(ItemQuantity.Key, ItemQuantity.Value);
 	}
-	return ItemsRemoved;
+	const bool bRemoved = Transaction.Commit();
+	
+	INVENTORY_DEBUG_LOG(bShowDebug, Display,
+		"{Inventory}({Sv}): RemoveItems() {Result} - {NumItems} Items Requested",
+		GetName(), HasAuthority()?"SRV":"CLI", bRemoved ? "Finished" : "Failed", ItemQuantities.Num());
+	
+	return bRemoved;
 }
 
 /**
@@ -1252,7 +1502,7 @@ int UInventoryComponent::SwapOrStackSlots(
 {
     if (!IsValid(OriginSlot->GetParentInventory()) && !IsValid(TargetSlot->GetParentInventory()))
     {
-    	UE_LOGFMT(LogTemp, Warning,
+    	UE_LOGFMT(LogInventory, Warning,
 			"{Inventory}({Sv}): SwapOrStackWithRemainder() Failed - "
 			"Swap Slots must have a valid parent inventory.",
 			GetName(), HasAuthority()?"SRV":"CLI");
@@ -1262,7 +1512,7 @@ int UInventoryComponent::SwapOrStackSlots(
     // If origin slot is empty, what are they swapping/stacking? Use Add & Remove.
     if (OriginSlot->IsEmpty() || TargetSlot->IsEmpty())
     {
-    	UE_LOGFMT(LogTemp, Log,
+    	INVENTORY_DEBUG_LOG(bShowDebug, Log,
 			"{Inventory}({Sv}): SwapOrStackWithRemainder() Failed - Slot #{SlotNum} is an Empty Slot",
 			GetName(), HasAuthority()?"SRV":"CLI", TargetSlot->GetSlotNumber());
         return false;
@@ -1275,7 +1525,6 @@ int UInventoryComponent::SwapOrStackSlots(
 	int TargetQuantity = TargetSlot->GetQuantity();
 	
 	const UItemDataAsset* OriginItem 	= OriginSlot->GetItemData();
-	const UItemDataAsset* TargetItem 	= TargetSlot->GetItemData();
 
 	const FItemStatics OriginStaticsCopy = OriginSlot->GetItemStatics();
 	const FItemStatics TargetStaticsCopy = TargetSlot->GetItemStatics();
@@ -1291,9 +1540,9 @@ int UInventoryComponent::SwapOrStackSlots(
 	if (OriginSlot->GetIsEquipmentSlot() && IsValid(TargetEquipment))
 	{
 		// Checks if the origin slot contains any of the equipment's tags
-		if (!OriginSlot->ContainsTag(TargetEquipment->EquippableSlots))
+		if (!OriginSlot->GetSlotData().CanEquipItem(TargetSlot->GetSlotData().GetItemDefinition()))
 		{
-			UE_LOGFMT(LogTemp, Log,
+			INVENTORY_DEBUG_LOG(bShowDebug, Log,
 				"{Inventory}({Sv}): SwapOrStackWithRemainder() Failed - "
 				"Target (Slot {nTargetSlot}) is not a valid equipment slot for the origin item (Slot {nOriginSlot}).",
 				GetName(), HasAuthority()?"SRV":"CLI", TargetSlot->GetSlotNumber(), OriginSlot->GetSlotNumber());
@@ -1305,9 +1554,9 @@ int UInventoryComponent::SwapOrStackSlots(
 	if (TargetSlot->GetIsEquipmentSlot() && IsValid(OriginEquipment))
 	{
 		// Checks if the target slot contains any of the equipment's tags
-		if (!TargetSlot->ContainsTag(OriginEquipment->EquippableSlots))
+		if (!TargetSlot->GetSlotData().CanEquipItem(OriginSlot->GetSlotData().GetItemDefinition()))
 		{
-			UE_LOGFMT(LogTemp, Log,
+			INVENTORY_DEBUG_LOG(bShowDebug, Log,
 				"{Inventory}({Sv}): SwapOrStackWithRemainder() Failed - "
 				"Target (Slot {nTargetSlot}) is not a valid equipment slot for the origin item (Slot {nOriginSlot}).",
 				GetName(), HasAuthority()?"SRV":"CLI", OriginSlot->GetSlotNumber(), TargetSlot->GetSlotNumber());
@@ -1319,7 +1568,7 @@ int UInventoryComponent::SwapOrStackSlots(
 	 * Validates like-items
 	 */
 	const bool	isSameExactItem = TargetSlot->ContainsItem(OriginItem, OriginSlot->GetItemStatics());
-	const int   MaxStackSize	= TargetItem->GetItemMaxStackSize();
+	const int   MaxStackSize	= TargetSlot->GetMaxStackAllowance();
 
 	// Exact same item, and stackable
     if (isSameExactItem && (MaxStackSize > 1))
@@ -1327,7 +1576,7 @@ int UInventoryComponent::SwapOrStackSlots(
     	const int SpaceRemaining = TargetSlot->GetMaxStackAllowance() - TargetSlot->GetQuantity();
     	if (SpaceRemaining < 1)
     	{
-			UE_LOGFMT(LogTemp, Display,
+			INVENTORY_DEBUG_LOG(bShowDebug, Display,
 				"{Inventory}({Sv}): {InvName}({SlotNum}) has no space for origin stack request.",
 				GetName(), HasAuthority()?"SRV":"CLI",
 				TargetSlot->GetParentInventory()->GetName(), TargetSlot->GetSlotNumber());
@@ -1341,18 +1590,18 @@ int UInventoryComponent::SwapOrStackSlots(
     		if (itemsAdded > 0)
     		{
     			RemainingQuantity -= itemsAdded;
-    			UE_LOGFMT(LogTemp, Display,
+    			INVENTORY_DEBUG_LOG(bShowDebug, Display,
 					"{Inventory}({Sv}): Successfully Stacked x{nQuantity} of {ItemName}",
 					GetName(), HasAuthority()?"SRV":"CLI", itemsAdded, OriginItem->GetName());
     			return true;
     		}
-    		UE_LOGFMT(LogTemp, Error,
+    		UE_LOGFMT(LogInventory, Error,
 				"{Inventory}({Sv}): SwapOrStackWithRemainder() - "
 				"Internal Request to TargetSlot->IncreaseQuantityInSlot Failed",
 				GetName(), HasAuthority()?"SRV":"CLI");
     		return false;
     	}
-    	UE_LOGFMT(LogTemp, Error,
+    	UE_LOGFMT(LogInventory, Error,
 			"{Inventory}({Sv}): SwapOrStackWithRemainder() - "
 			"Internal Request to OriginSlot->DecreaseQuantityInSlot Failed",
 			GetName(), HasAuthority()?"SRV":"CLI");
@@ -1364,7 +1613,7 @@ int UInventoryComponent::SwapOrStackSlots(
 	TargetSlot->SetItem(OriginStaticsCopy, OriginQuantity);
 	RemainingQuantity = 0;
 	
-    UE_LOGFMT(LogTemp, Display,
+    INVENTORY_DEBUG_LOG(bShowDebug, Display,
 		"{Inventory}({Sv}): Successfully Swapped {OriginInv}({OriginNum}) with {TargetInv}({TargetNum})",
 		GetName(), HasAuthority()?"SRV":"CLI",
 		OriginSlot->GetParentInventory()->GetName(), OriginSlot->GetSlotNumber(),
@@ -1372,63 +1621,6 @@ int UInventoryComponent::SwapOrStackSlots(
 	return true;
 }
 
-/**
- * @brief Finds which slots have changed, and sends an update event
- */
-void UInventoryComponent::OnRep_InventorySlotUpdated_Implementation(const TArray<UInventorySlot*>& OldSlots)
-{
-	for (int i = 0; i < GetNumberOfTotalSlots(); i++)
-	{
-		// Existing slot updated
-		if (OldSlots.IsValidIndex(i))
-		{
-			const UInventorySlot* CurrentSlot = GetInventorySlot(i);
-			const UInventorySlot* OldSlotRef  = OldSlots[i];
-			
-			if (   CurrentSlot->GetItemStatics() != OldSlotRef->GetItemStatics()
-				|| CurrentSlot->GetItemName()	 != OldSlotRef->GetItemName()  )
-			{
-				UE_LOGFMT(LogTemp, Log,
-					"{Inventory}({Sv}) REPNOTIFY: Updated Inventory Slot {SlotNum}",
-					GetName(), HasAuthority()?"SRV":"CLI", i);
-				if (OnInventoryUpdated.IsBound())
-				{
-					OnInventoryUpdated.Broadcast(i);
-				}
-			}
-			
-			// The item or its quantity has changed
-			else if ( CurrentSlot->GetQuantity() != OldSlotRef->GetQuantity() )
-			{
-				// One of the slots must have a valid item in order to be valid
-				// i.e. there was no update if the slot was empty before and after
-				if (CurrentSlot->ContainsValidItem() || OldSlotRef->ContainsValidItem())
-				{
-					UE_LOGFMT(LogTemp, Log,
-						"{Inventory}({Sv}) REPNOTIFY: Updated Inventory Slot {SlotNum}",
-						GetName(), HasAuthority()?"SRV":"CLI", i);
-					if (OnInventoryUpdated.IsBound())
-					{
-						OnInventoryUpdated.Broadcast(i);
-					}
-				}
-			}
-		}
-		
-		// New Slot Added
-		else
-		{
-			UE_LOGFMT(LogTemp, Log,
-				"{Inventory}({Sv}) REPNOTIFY: Added Inventory Slot {SlotNum}",
-				GetName(), HasAuthority()?"SRV":"CLI", i);
-			if (OnInventoryUpdated.IsBound())
-			{
-				OnInventoryUpdated.Broadcast(i);
-			}
-		}
-	}
-}
-
 void UInventoryComponent::Server_RestoreSavedInventory_Implementation(
 	const TArray<FInventorySlotSaveData>& RestoredInventory)
 {
@@ -1438,7 +1630,7 @@ void UInventoryComponent::Server_RestoreSavedInventory_Implementation(
 	}
 	else
 	{
-		UE_LOGFMT(LogTemp, Log,
+		INVENTORY_DEBUG_LOG(bShowDebug, Log,
 			"{Inventory}({Sv}): Request to restore inventory must run on the authority.",
 			GetName(), HasAuthority()?"SRV":"CLI");
 	}
@@ -1460,7 +1652,7 @@ int UInventoryComponent::SplitStack(
 {
 	if (OriginSlot->IsEmpty())
 	{
-		UE_LOGFMT(LogTemp, Display,
+		INVENTORY_DEBUG_LOG(bShowDebug, Display,
 			"{Inventory}({Sv}) Failed - Origin Slot is Empty ({InvName} Slot {SlotNum})",
 			GetName(), HasAuthority()?"SRV":"CLI",
 			OriginSlot->GetParentInventory()->GetName(), OriginSlot->GetSlotNumber());
@@ -1482,19 +1674,19 @@ int UInventoryComponent::SplitStack(
 					const int itemsAdded = TargetSlot->IncreaseQuantity(itemsRemoved);
 					if (itemsAdded > 0)
 					{
-						UE_LOGFMT(LogTemp, Display,
+						INVENTORY_DEBUG_LOG(bShowDebug, Display,
 							"{Inventory}({Sv}): Successfully stacked {nQuantity}",
 							GetName(), HasAuthority()?"SRV":"CLI", itemsAdded);
 					}
 				}
 			}
 		}
-		UE_LOGFMT(LogTemp, Warning,
+		UE_LOGFMT(LogInventory, Warning,
 			"{Inventory}({Sv}) Failed - .",
 			GetName(), HasAuthority()?"SRV":"CLI");
 	}
 	
-	UE_LOGFMT(LogTemp, Display,
+	INVENTORY_DEBUG_LOG(bShowDebug, Display,
 		"{Inventory}({Sv}): Successfully split off {NumSplit} from {OriginInv} Slot #{SlotNum}",
 		GetName(), HasAuthority()?"SRV":"CLI", OrderQuantity,
 		OriginSlot->GetParentInventory()->GetName(), OriginSlot->GetSlotNumber());
@@ -1512,11 +1704,18 @@ int UInventoryComponent::SplitStack(
 */
 int UInventoryComponent::IncreaseSlotQuantity(int SlotNumber, int OrderQuantity, bool bNotify)
 {
-    if (IsValidSlotNumber(SlotNumber))
-    {
-	    GetInventorySlot(SlotNumber)->IncreaseQuantity(OrderQuantity);
-    }
-	return 0;
+    if (!IsValidSlotNumber(SlotNumber)) { return -1; }
+	if (InventorySlots_[SlotNumber].IsEmpty()) { return -1; }
+
+	const int AdjustQuantity = abs(OrderQuantity);
+	int StartQuantity, NewQuantity;
+	{
+		FRWScopeLock WriteLock(InventoryMutex, SLT_Write);
+		StartQuantity	= InventorySlots_[SlotNumber].Quantity;
+		NewQuantity		= Helper_SetSlotQuantity(SlotNumber, StartQuantity + AdjustQuantity);
+	}
+	Helper_BroadcastPendingSlotChanges();
+	return NewQuantity >= 0 ? NewQuantity - StartQuantity : -1;
 }
 
 /**
@@ -1530,11 +1729,79 @@ int UInventoryComponent::IncreaseSlotQuantity(int SlotNumber, int OrderQuantity,
 */
 int UInventoryComponent::DecreaseSlotQuantity(int SlotNumber, int OrderQuantity, bool bNotify)
 {
-	if (IsValidSlotNumber(SlotNumber))
+	if (!IsValidSlotNumber(SlotNumber)) { return -1; }
+	if (InventorySlots_[SlotNumber].IsEmpty()) { return -1; }
+
+	const int AdjustQuantity = abs(OrderQuantity);
+	int StartQuantity, NewQuantity;
+	{
+		FRWScopeLock WriteLock(InventoryMutex, SLT_Write);
+		StartQuantity	= InventorySlots_[SlotNumber].Quantity;
+		NewQuantity		= Helper_SetSlotQuantity(SlotNumber, StartQuantity - AdjustQuantity);
+	}
+	Helper_BroadcastPendingSlotChanges();
+	return NewQuantity >= 0 ? StartQuantity - NewQuantity : -1;
+}
+
+/**
+* Sets the item in the given slot, replacing whatever was in the slot before.
+*
+* @param SlotNumber		The slot number to be set
+* @param ItemStatics	The item to put in the slot. An empty ItemName empties the slot.
+* @param NewQuantity	The new quantity, up to the maximum stack size of the item
+* @return				The new quantity in the slot. Negative indicates failure.
+*/
+int UInventoryComponent::SetSlotItem(int SlotNumber, const FItemStatics& ItemStatics, int NewQuantity)
+{
+	if (!IsValidSlotNumber(SlotNumber)) { return -1; }
+	int SlotQuantity;
+	{
+		FRWScopeLock WriteLock(InventoryMutex, SLT_Write);
+		SlotQuantity = Helper_SetSlotItem(SlotNumber, ItemStatics, NewQuantity);
+	}
+	Helper_BroadcastPendingSlotChanges();
+	return SlotQuantity;
+}
+
+/**
+* Sets the quantity of the item in the given slot. Zero or less empties the slot.
+*
+* @param SlotNumber		The slot number to be set
+* @param NewQuantity	The new quantity, up to the maximum stack size of the item
+* @return				The new quantity in the slot. Negative indicates failure.
+*/
+int UInventoryComponent::SetSlotQuantity(int SlotNumber, int NewQuantity)
+{
+	if (!IsValidSlotNumber(SlotNumber)) { return -1; }
+	int SlotQuantity;
 	{
-		GetInventorySlot(SlotNumber)->DecreaseQuantity(OrderQuantity);
+		FRWScopeLock WriteLock(InventoryMutex, SLT_Write);
+		SlotQuantity = Helper_SetSlotQuantity(SlotNumber, NewQuantity);
 	}
-	return 0;
+	Helper_BroadcastPendingSlotChanges();
+	return SlotQuantity;
+}
+
+/**
+* Sets the durability of the item in the given slot, if the item is fragile.
+*
+* @param SlotNumber		The slot number to be set
+* @param NewDurability	The new durability value
+* @return				True if the durability was changed
+*/
+bool UInventoryComponent::SetSlotDurability(int SlotNumber, float NewDurability)
+{
+	if (!IsValidItemInSlot(SlotNumber)) { return false; }
+	if (InventorySlots_[SlotNumber].GetItemMaxDurability() <= 0.f) { return false; }
+
+	{
+		FRWScopeLock WriteLock(InventoryMutex, SLT_Write);
+		const FInventorySlotData PreviousSlot = InventorySlots_[SlotNumber];
+		InventorySlots_[SlotNumber].ItemStatics.Durability = NewDurability;
+		Helper_SlotChanged(SlotNumber, PreviousSlot);
+	}
+	Helper_BroadcastPendingSlotChanges();
+	return true;
 }
 
 /**
@@ -1548,7 +1815,8 @@ TArray<FStInventoryNotify> UInventoryComponent::GetNotifications()
     {
         invNotify = Notifications_;
     	Notifications_.Empty();
-    	UE_LOGFMT(LogTemp, Log,
+    	MARK_INVENTORY_PROPERTY_DIRTY(UInventoryComponent, Notifications_);
+    	INVENTORY_DEBUG_LOG(bShowDebug, Log,
 			"{Inventory}({Sv}): GetNotifications() found {n} pending notifications",
 			GetName(), HasAuthority()?"SRV":"CLI", invNotify.Num());
         return invNotify;
@@ -1582,7 +1850,7 @@ bool UInventoryComponent::TransferItemBetweenSlots(
 {
 	if (OriginSlot->IsEmpty())
 	{
-		UE_LOGFMT(LogTemp, Warning,
+		UE_LOGFMT(LogInventory, Warning,
 			"{Inventory}({Sv}): tried to transfer from {InvName}({SlotNum}), but the slot is EMPTY",
 			GetName(), HasAuthority()?"SRV":"CLI",
 			OriginSlot->GetParentInventory()->GetName(), OriginSlot->GetSlotNumber());
@@ -1615,7 +1883,7 @@ bool UInventoryComponent::TransferItemBetweenSlots(
         }
     }
 	
-	UE_LOGFMT(LogTemp, Log,
+	INVENTORY_DEBUG_LOG(bShowDebug, Log,
 		"{Inventory}({Sv}): Transfer Failed",
 		GetName(), HasAuthority()?"SRV":"CLI");
     return false;
@@ -1635,10 +1903,8 @@ bool UInventoryComponent::ActivateSlot(int SlotNumber, bool bForceConsume)
     if (IsValidSlotNumber(SlotNumber))
     {
 		UInventorySlot* ActivatedSlot = GetInventorySlot(SlotNumber);
-    	
-    	const UItemDataAsset* ItemInSlot(ActivatedSlot->GetItemData());
 
-    	if (ItemInSlot->GetItemCanActivate())
+    	if (ActivatedSlot->GetSlotData().GetItemCanActivate())
     	{
     		ActivatedSlot->ActivateSlot();
     	}
@@ -1651,14 +1917,14 @@ bool UInventoryComponent::ActivateSlot(int SlotNumber, bool bForceConsume)
 void UInventoryComponent::Server_RequestItemActivation_Implementation(
     UInventoryComponent* OriginInventory, int SlotNumber)
 {
-    if (HasAuthority() && IsValid(OriginInventory))
+    UInventorySlot* ActivatedSlot = GetInventorySlot(SlotNumber);
+    if (HasAuthority() && IsValid(OriginInventory) && IsValid(ActivatedSlot))
     {
-    	UInventorySlot* ActivatedSlot = GetInventorySlot(SlotNumber);
     	ActivatedSlot->ActivateSlot();
     }
 	else
 	{
-    	UE_LOGFMT(LogTemp, Log,
+    	INVENTORY_DEBUG_LOG(bShowDebug, Log,
 			"{Inventory}({Sv}): Server_RequestItemActivation Authority Violation or NULLPTR",
 			GetName(), HasAuthority()?"SRV":"CLI");
 	}
@@ -1684,7 +1950,17 @@ void UInventoryComponent::LoadDataDelegate(const FString& SaveSlotName, int32 Us
 		}
 	}
 
-	RestoreInventory( InventorySave->SavedInventorySlots );
+	// Older saves come back in the legacy format and are rewritten compactly on the next save
+	TArray<FInventorySlotSaveData> RestoredSlots;
+	if (!InventorySave->LoadInventorySlots(RestoredSlots))
+	{
+		UE_LOGFMT(LogInventory, Warning, "{Inventory}({Sv}): Save '{SaveName}' has corrupt or unsupported slot data",
+			GetName(), HasAuthority()?"SRV":"CLI", SaveSlotName_);
+		if (OnInventoryRestored.IsBound()) { OnInventoryRestored.Broadcast(false); }
+		return;
+	}
+
+	RestoreInventory( RestoredSlots );
 	if (OnInventoryRestored.IsBound()) { OnInventoryRestored.Broadcast(true); }
 }
 
@@ -1697,7 +1973,7 @@ void UInventoryComponent::LoadDataDelegate(const FString& SaveSlotName, int32 Us
  void UInventoryComponent::SaveInventoryDelegate(
  		const FString& SaveSlotName, int32 UserIndex, const bool bSuccess)
 {
-	UE_LOGFMT(LogTemp, Log,
+	INVENTORY_DEBUG_LOG(bShowDebug, Log,
 		"{Inventory}({Sv}): (Async Response) {SuccessTruth} the inventory with name '{SaveName}' @ index {Index}'",
 		GetName(), HasAuthority()?"SRV":"CLI", bSuccess?"Successfully Saved":"Failed to Save", SaveSlotName_, SaveUserIndex_);
 	if (OnInventoryRestored.IsBound()) { OnInventoryRestored.Broadcast(bSuccess); }
@@ -1710,13 +1986,596 @@ void UInventoryComponent::MapEquipmentSlot(const FGameplayTag& EquipmentTag, int
 }
 
 
+/**
+ * Puts the given item into the slot. Caller must hold the write lock.
+ * @param SlotNumber The slot to set
+ * @param ItemStatics The item to set. None empties the slot.
+ * @param NewQuantity The quantity to set, clamped to the max stack size if the asset is resident
+ * @param ItemData (opt) The data asset of the item, if the caller already has it
+ * @return The new quantity of the slot. Negative indicates failure.
+ */
+int UInventoryComponent::Helper_SetSlotItem(int SlotNumber, const FItemStatics& ItemStatics,
+	int NewQuantity, const UItemDataAsset* ItemData)
+{
+	if (!IsValidSlotNumber(SlotNumber)) { return -1; }
+
+	FInventorySlotData& InventorySlot = InventorySlots_[SlotNumber];
+	const FInventorySlotData PreviousSlot = InventorySlot;
+
+	if (ItemStatics.ItemName.IsNone() || NewQuantity < 1)
+	{
+		InventorySlot.ResetItem();
+	}
+	else
+	{
+		InventorySlot.ItemStatics	= ItemStatics;
+		InventorySlot.Quantity		= NewQuantity;
+		InventorySlot.SetDataAsset(ItemData);
+		if (!IsValid(ItemData) || ItemData->GetPrimaryAssetId().PrimaryAssetName != ItemStatics.ItemName)
+		{
+			Helper_LoadSlotAsset(SlotNumber);
+		}
+		if (InventorySlot.ContainsValidItem())
+		{
+			InventorySlot.Quantity = FMath::Min(NewQuantity, InventorySlot.GetMaxStackAllowance());
+		}
+	}
+	Helper_SlotChanged(SlotNumber, PreviousSlot);
+	return InventorySlot.Quantity;
+}
+
+
+/**
+ * Sets the quantity of the slot. Caller must hold the write lock.
+ * @param SlotNumber The slot to set
+ * @param NewQuantity The quantity to set. Zero or less empties the slot.
+ * @return The new quantity of the slot. Negative indicates failure.
+ */
+int UInventoryComponent::Helper_SetSlotQuantity(int SlotNumber, int NewQuantity)
+{
+	if (!IsValidSlotNumber(SlotNumber)) { return -1; }
+
+	FInventorySlotData& InventorySlot = InventorySlots_[SlotNumber];
+	if (InventorySlot.GetItemName().IsNone()) { return -1; }
+
+	const FInventorySlotData PreviousSlot = InventorySlot;
+	if (NewQuantity < 1)
+	{
+		InventorySlot.ResetItem();
+	}
+	else
+	{
+		// Without the asset the stack size is unknown, so the quantity is kept as it is
+		InventorySlot.Quantity = InventorySlot.ContainsValidItem()
+			? FMath::Min(NewQuantity, InventorySlot.GetMaxStackAllowance()) : NewQuantity;
+	}
+	Helper_SlotChanged(SlotNumber, PreviousSlot);
+	return InventorySlot.Quantity;
+}
+
+
+/**
+ * Resolves the data asset of the item if it is resident, and requests it in the background if not.
+ * Does not take the inventory lock or wait on the load, so it can be called while holding the lock.
+ * @param ItemStatics The item to resolve
+ * @return The data asset, or nullptr if it is not resident yet
+ */
+const UItemDataAsset* UInventoryComponent::Helper_RequestItemData(const FItemStatics& ItemStatics)
+{
+	if (const UItemDataAsset* ItemData = ItemStatics.GetItemData()) { return ItemData; }
+
+	const FItemDefinitionCache& Cache = FItemDefinitionCache::Get();
+	const FItemDefinition* Definition = Cache.Find(Cache.FindItemId(ItemStatics.ItemName));
+	if (Definition != nullptr && Definition->AssetId.IsValid())
+	{
+		Helper_RequestAssets({ Definition->AssetId }, false);
+	}
+	return nullptr;
+}
+
+
+/**
+ * Plans an add in one pass: the requested slot first, then partial stacks of the exact
+ * same item in slot order, then empty inventory slots in slot order.
+ * @param ItemStatics The item to add
+ * @param OrderQuantity How many to add
+ * @param SlotNumber The slot to fill first. Negative means none.
+ * @param bAddOverflow If false, the add goes into a single slot: SlotNumber if one was given,
+ *                     otherwise the first slot the item fits in
+ * @param OutPlan The slots to fill and by how much, and what is left over
+ * @param SkipSlotNumber If not negative, this slot is never filled
+ */
+void UInventoryComponent::Helper_PlanAddItem(const FItemStatics& ItemStatics, int OrderQuantity,
+	int SlotNumber, bool bAddOverflow, FInventoryAddPlan& OutPlan, int SkipSlotNumber) const
+{
+	OutPlan.Placements.Reset();
+	OutPlan.Remainder = FMath::Max(OrderQuantity, 0);
+	if (ItemStatics.ItemName.IsNone() || OutPlan.Remainder < 1) { return; }
+
+	// Resolving a resident asset also makes sure its definition is filled in
+	ItemStatics.GetItemData();
+	const FItemDefinitionCache& Cache = FItemDefinitionCache::Get();
+	const FItemDefinition* Definition = Cache.Find(Cache.FindItemId(ItemStatics.ItemName));
+
+	// The stack size comes from the asset registry, so the asset does not have to be loaded.
+	// An item without the tag has no known stack size until its asset lands,
+	// so no slot gets more than one.
+	const int MaxStackSize = (Definition != nullptr && (Definition->bResolved || Definition->bStackSizeKnown))
+		? FMath::Max(Definition->MaxStackSize, 1) : 1;
+
+	const auto PlaceInSlot = [&](int TargetSlotNumber)
+	{
+		if (TargetSlotNumber == SkipSlotNumber) { return; }
+		INC_DWORD_STAT(STAT_InventorySlotsScanned);
+		const FInventorySlotData& TargetSlot = InventorySlots_[TargetSlotNumber];
+		int Room = 0;
+		if (TargetSlot.IsEmpty())
+		{
+			Room = MaxStackSize;
+		}
+		else if (TargetSlot.ContainsItem(ItemStatics.ItemName, ItemStatics))
+		{
+			Room = MaxStackSize - TargetSlot.Quantity;
+		}
+		const int Quantity = FMath::Min(Room, OutPlan.Remainder);
+		if (Quantity > 0)
+		{
+			OutPlan.Placements.Add({TargetSlotNumber, Quantity});
+			OutPlan.Remainder -= Quantity;
+		}
+	};
+
+	// Without overflow, the first slot that takes any of the item is the only one
+	const auto IsPlanDone = [&]()
+	{
+		return OutPlan.Remainder < 1 || (!bAddOverflow && !OutPlan.Placements.IsEmpty());
+	};
+
+	if (SlotNumber >= 0)
+	{
+		if (IsValidSlotNumber(SlotNumber))
+		{
+			PlaceInSlot(SlotNumber);
+		}
+		if (!bAddOverflow) { return; }
+	}
+
+	if (MaxStackSize > 1)
+	{
+		if (const FInventoryItemIndexEntry* IndexEntry = ItemIndex_.Find(ItemStatics.ItemName))
+		{
+			for (const int MatchingSlot : IndexEntry->SlotNumbers)
+			{
+				// Slot numbers are ascending, so the rest are equipment slots
+				if (IsPlanDone() || MatchingSlot >= EquipmentSlotsStart_) { break; }
+				if (MatchingSlot != SlotNumber)
+				{
+					PlaceInSlot(MatchingSlot);
+				}
+			}
+		}
+	}
+
+	for (TConstSetBitIterator<> It(EmptyInventorySlots_); It && !IsPlanDone(); ++It)
+	{
+		if (It.GetIndex() != SlotNumber)
+		{
+			PlaceInSlot(It.GetIndex());
+		}
+	}
+}
+
+
+/**
+ * Single exit point for every change to the packed slot data. While a transaction
+ * is active the change is handed to it, and published when the transaction commits.
+ * Otherwise it is queued, and published by Helper_BroadcastPendingSlotChanges once
+ * the caller has released the lock.
+ * @param SlotNumber The slot that changed
+ * @param PreviousSlot A copy of the slot from before the change
+ */
+void UInventoryComponent::Helper_SlotChanged(int SlotNumber, const FInventorySlotData& PreviousSlot)
+{
+	Helper_UpdateSlotState(SlotNumber, PreviousSlot);
+	if (ActiveTransaction_ != nullptr)
+	{
+		ActiveTransaction_->Helper_RecordSlotChange(SlotNumber, PreviousSlot);
+		return;
+	}
+
+	Helper_MarkSlotDirty(SlotNumber);
+	PendingSlotBroadcasts_.Emplace(SlotNumber, PreviousSlot.DataAsset);
+}
+
+
+/**
+ * Publishes the slot changes queued by Helper_SlotChanged, and any weight threshold
+ * they crossed. Must be called without holding the lock, as listeners may lock it again.
+ */
+void UInventoryComponent::Helper_BroadcastPendingSlotChanges()
+{
+	// Listeners that change slots queue (and publish) their own changes
+	const TArray<TPair<int, const UItemDataAsset*>> SlotChanges = MoveTemp(PendingSlotBroadcasts_);
+	PendingSlotBroadcasts_.Reset();
+	for (const TPair<int, const UItemDataAsset*>& SlotChange : SlotChanges)
+	{
+		Helper_BroadcastSlotChanged(SlotChange.Key, SlotChange.Value);
+	}
+	Helper_CheckWeightThreshold();
+}
+
+
+void UInventoryComponent::Helper_UpdateSlotState(int SlotNumber, const FInventorySlotData& PreviousSlot)
+{
+	Helper_RemoveFromItemIndex(SlotNumber, PreviousSlot);
+	Helper_AddToItemIndex(SlotNumber, InventorySlots_[SlotNumber]);
+	Helper_UpdateSlotOccupancy(SlotNumber);
+
+	FInventorySlotData& InventorySlot = InventorySlots_[SlotNumber];
+	InventorySlot.LastObservedItemName	= InventorySlot.GetItemName();
+	InventorySlot.LastObservedQuantity	= InventorySlot.Quantity;
+
+	const float WeightDelta = InventorySlot.GetCarryWeight() - PreviousSlot.GetCarryWeight();
+	if (!FMath::IsNearlyZero(WeightDelta))
+	{
+		if (SlotNumber >= EquipmentSlotsStart_)	{ EquipmentWeight_ += WeightDelta; }
+		else									{ InventoryWeight_ += WeightDelta; }
+	}
+}
+
+
+void UInventoryComponent::Helper_MarkSlotDirty(int SlotNumber)
+{
+	if (!HasAuthority()) { return; }
+	InventorySlots_.MarkItemDirty(InventorySlots_[SlotNumber]);
+	MARK_INVENTORY_PROPERTY_DIRTY(UInventoryComponent, InventorySlots_);
+	if (SlotGenerations_.IsValidIndex(SlotNumber))
+	{
+		SlotGenerations_[SlotNumber] = ++SlotGeneration_;
+	}
+	Helper_MarkPersistenceDirty();
+}
+
+
+void UInventoryComponent::Helper_BroadcastSlotChanged(
+	int SlotNumber, const UItemDataAsset* PreviousItem, bool bNotifyInventory)
+{
+	if (bNotifyInventory)
+	{
+		NotifySlotUpdated(SlotNumber);
+	}
+	else
+	{
+		Helper_QueueBatchedSlotUpdate(SlotNumber);
+	}
+	if (SlotObjects_.IsValidIndex(SlotNumber) && IsValid(SlotObjects_[SlotNumber]))
+	{
+		SlotObjects_[SlotNumber]->BroadcastSlotChanged(PreviousItem);
+	}
+}
+
+
+/**
+ * A single slot was changed by replication. The replicated fields already hold
+ * the new values, so the previous state is rebuilt from the last observed values.
+ * @param SlotNumber The slot that was replicated
+ */
+void UInventoryComponent::Helper_SlotReplicated(int SlotNumber)
+{
+	INVENTORY_SCOPE_CYCLE_COUNTER(STAT_InventorySlotReplicated);
+	{
+		FRWScopeLock WriteLock(InventoryMutex, SLT_Write);
+		if (!IsValidSlotNumber(SlotNumber)) { return; }
+
+		FInventorySlotData& InventorySlot = InventorySlots_[SlotNumber];
+		if (InventorySlot.SlotNumber != SlotNumber)
+		{
+			// The array is out of slot order, which only a layout rebuild puts right
+			InventorySlots_.bLayoutChanged = true;
+			return;
+		}
+		FInventorySlotData PreviousSlot = InventorySlot;
+		PreviousSlot.ItemStatics.ItemName	= InventorySlot.LastObservedItemName;
+		PreviousSlot.Quantity				= InventorySlot.LastObservedQuantity;
+
+		// The data asset is never replicated, so it has to be looked up again for a new item
+		if (InventorySlot.GetItemName() != InventorySlot.LastObservedItemName)
+		{
+			Helper_LoadSlotAsset(SlotNumber);
+		}
+		INVENTORY_DEBUG_LOG(bShowDebug, Log,
+			"{Inventory}({Sv}) REPNOTIFY: Updated Inventory Slot {SlotNum}",
+			GetName(), HasAuthority()?"SRV":"CLI", SlotNumber);
+		Helper_SlotChanged(SlotNumber, PreviousSlot);
+	}
+	Helper_BroadcastPendingSlotChanges();
+}
+
+
+/**
+ * Slots were added or removed by replication, so every slot is treated as new.
+ */
+void UInventoryComponent::Helper_SlotLayoutReplicated()
+{
+	INVENTORY_SCOPE_CYCLE_COUNTER(STAT_InventorySlotReplicated);
+	INC_DWORD_STAT_BY(STAT_InventorySlotsScanned, InventorySlots_.Num());
+	{
+		FRWScopeLock WriteLock(InventoryMutex, SLT_Write);
+
+		// Removes on the client don't keep the array order, and the index has to be the slot number.
+		// Marking the array dirty makes the fast array rebuild its id map for the new order.
+		InventorySlots_.Items.StableSort([](const FInventorySlotData& A, const FInventorySlotData& B)
+		{
+			return A.SlotNumber < B.SlotNumber;
+		});
+		InventorySlots_.MarkArrayDirty();
+		for (int i = 0; i < InventorySlots_.Num(); i++)
+		{
+			FInventorySlotData& InventorySlot = InventorySlots_[i];
+			InventorySlot.LastObservedItemName	= InventorySlot.GetItemName();
+			InventorySlot.LastObservedQuantity	= InventorySlot.Quantity;
+			InventorySlot.ResolveDataAsset();
+		}
+		Helper_UpdateSlotPartition();
+		Helper_RebuildEquipmentSlotMap();
+		Helper_RebuildItemIndex();
+		Helper_RebuildSlotOccupancy();
+		Helper_RebuildWeight();
+		bInventoryReady = false;
+		Helper_PreloadSlotAssets(true);
+	}
+	Helper_CheckWeightThreshold();
+	INVENTORY_DEBUG_LOG(bShowDebug, Log,
+		"{Inventory}({Sv}) REPNOTIFY: Inventory now has {NumSlots} Slots",
+		GetName(), HasAuthority()?"SRV":"CLI", InventorySlots_.Num());
+	for (int i = 0; i < InventorySlots_.Num(); i++)
+	{
+		NotifySlotUpdated(i);
+	}
+}
+
+
+void UInventoryComponent::Helper_AddToItemIndex(int SlotNumber, const FInventorySlotData& InventorySlot)
+{
+	if (InventorySlot.IsEmpty()) { return; }
+	FInventoryItemIndexEntry& IndexEntry = ItemIndex_.FindOrAdd(InventorySlot.GetItemName());
+
+	// Keep slot numbers ascending, so searches still find the lowest slot first
+	const int InsertAt = Algo::LowerBound(IndexEntry.SlotNumbers, SlotNumber);
+	if (!IndexEntry.SlotNumbers.IsValidIndex(InsertAt) || IndexEntry.SlotNumbers[InsertAt] != SlotNumber)
+	{
+		IndexEntry.SlotNumbers.Insert(SlotNumber, InsertAt);
+	}
+	IndexEntry.TotalQuantity += InventorySlot.Quantity;
+}
+
+
+void UInventoryComponent::Helper_RemoveFromItemIndex(int SlotNumber, const FInventorySlotData& InventorySlot)
+{
+	if (InventorySlot.IsEmpty()) { return; }
+	FInventoryItemIndexEntry* IndexEntry = ItemIndex_.Find(InventorySlot.GetItemName());
+	if (IndexEntry == nullptr) { return; }
+
+	IndexEntry->SlotNumbers.Remove(SlotNumber);
+	IndexEntry->TotalQuantity -= InventorySlot.Quantity;
+	if (IndexEntry->SlotNumbers.IsEmpty())
+	{
+		ItemIndex_.Remove(InventorySlot.GetItemName());
+	}
+}
+
+
+void UInventoryComponent::Helper_RebuildItemIndex()
+{
+	INC_DWORD_STAT_BY(STAT_InventorySlotsScanned, InventorySlots_.Num());
+	ItemIndex_.Empty();
+	for (int i = 0; i < InventorySlots_.Num(); i++)
+	{
+		Helper_AddToItemIndex(i, InventorySlots_[i]);
+	}
+}
+
+
+void UInventoryComponent::Helper_UpdateSlotOccupancy(int SlotNumber)
+{
+	// The slot layout changed (e.g. through replication), so start over
+	if (EmptyInventorySlots_.Num() != InventorySlots_.Num())
+	{
+		Helper_RebuildSlotOccupancy();
+		return;
+	}
+	const FInventorySlotData& InventorySlot = InventorySlots_[SlotNumber];
+	const bool bIsEquipment = InventorySlot.GetIsEquipmentSlot();
+	const bool bIsEmpty		= InventorySlot.IsEmpty();
+
+	// The counters only move when a bit flips, so the summaries below never scan the bitsets
+	const bool bWasEmptyInventory = EmptyInventorySlots_[SlotNumber];
+	const bool bWasEmptyEquipment = EmptyEquipmentSlots_[SlotNumber];
+	EmptyInventorySlots_[SlotNumber] = bIsEmpty && !bIsEquipment;
+	EmptyEquipmentSlots_[SlotNumber] = bIsEmpty && bIsEquipment;
+	NumEmptyInventorySlots_ += static_cast<int>(EmptyInventorySlots_[SlotNumber]) - static_cast<int>(bWasEmptyInventory);
+	NumEmptyEquipmentSlots_ += static_cast<int>(EmptyEquipmentSlots_[SlotNumber]) - static_cast<int>(bWasEmptyEquipment);
+
+	bInventoryFull = NumEmptyInventorySlots_ == 0;
+	Helper_UpdateContainsItems();
+}
+
+
+void UInventoryComponent::Helper_RebuildSlotOccupancy()
+{
+	INC_DWORD_STAT_BY(STAT_InventorySlotsScanned, InventorySlots_.Num());
+	EmptyInventorySlots_.Init(false, InventorySlots_.Num());
+	EmptyEquipmentSlots_.Init(false, InventorySlots_.Num());
+	NumEmptyInventorySlots_ = 0;
+	NumEmptyEquipmentSlots_ = 0;
+	for (int i = 0; i < InventorySlots_.Num(); i++)
+	{
+		const FInventorySlotData& InventorySlot = InventorySlots_[i];
+		if (InventorySlot.IsEmpty())
+		{
+			if (InventorySlot.GetIsEquipmentSlot())	{ EmptyEquipmentSlots_[i] = true; NumEmptyEquipmentSlots_++; }
+			else									{ EmptyInventorySlots_[i] = true; NumEmptyInventorySlots_++; }
+		}
+	}
+	bInventoryFull = NumEmptyInventorySlots_ == 0;
+	Helper_UpdateContainsItems();
+}
+
+
+void UInventoryComponent::Helper_UpdateContainsItems()
+{
+	if (!HasAuthority()) { return; }
+	const bool bContainsItems = NumEmptyInventorySlots_ + NumEmptyEquipmentSlots_ < InventorySlots_.Num();
+	if (bContainsItems != bContainsItems_)
+	{
+		bContainsItems_ = bContainsItems;
+		MARK_INVENTORY_PROPERTY_DIRTY(UInventoryComponent, bContainsItems_);
+	}
+}
+
+
+void UInventoryComponent::Helper_LoadSlotAsset(int SlotNumber)
+{
+	if (!IsValidSlotNumber(SlotNumber)) { return; }
+	FInventorySlotData& InventorySlot = InventorySlots_[SlotNumber];
+	if (!InventorySlot.ResolveDataAsset())
+	{
+		Helper_RequestAssets({ InventorySlot.GetPrimaryAssetId() }, false);
+	}
+}
+
+
+/**
+ * Gathers the unique item assets of all slots that are not loaded yet, and requests them
+ * as one batch. Does not take the inventory lock, so it can be called while holding it.
+ * @param bMarkReady If true, bInventoryReady is set (and OnInventoryReady broadcast) once nothing is loading
+ */
+void UInventoryComponent::Helper_PreloadSlotAssets(bool bMarkReady)
+{
+	INC_DWORD_STAT_BY(STAT_InventorySlotsScanned, InventorySlots_.Num());
+	TArray<FPrimaryAssetId> AssetIds;
+	for (FInventorySlotData& InventorySlot : InventorySlots_)
+	{
+		if (InventorySlot.GetItemName().IsNone() || IsValid(InventorySlot.DataAsset)) { continue; }
+		if (!InventorySlot.ResolveDataAsset())
+		{
+			AssetIds.AddUnique(InventorySlot.GetPrimaryAssetId());
+		}
+	}
+	Helper_RequestAssets(AssetIds, bMarkReady);
+}
+
+
+void UInventoryComponent::Helper_RequestAssets(const TArray<FPrimaryAssetId>& AssetIds, bool bMarkReady)
+{
+	bReadyWhenLoaded_ |= bMarkReady;
+
+	TArray<FPrimaryAssetId> NewAssetIds;
+	for (const FPrimaryAssetId& AssetId : AssetIds)
+	{
+		if (AssetId.IsValid() && !RequestedAssets_.Contains(AssetId))
+		{
+			NewAssetIds.Add(AssetId);
+		}
+	}
+
+	// Completion is always deferred, as callers may be holding the inventory lock
+	if (!NewAssetIds.IsEmpty())
+	{
+		RequestedAssets_.Append(NewAssetIds);
+		INC_DWORD_STAT_BY(STAT_InventoryAssetLoads, NewAssetIds.Num());
+		TSharedPtr<FStreamableHandle> AssetHandle = UAssetManager::Get().LoadPrimaryAssets(NewAssetIds, {},
+			FStreamableDelegate::CreateUObject(this, &UInventoryComponent::SlotAssetsLoaded));
+		if (AssetHandle.IsValid())
+		{
+			AssetHandles_.Add(AssetHandle);
+		}
+		else if (IsValid(GetWorld()))
+		{
+			GetWorld()->GetTimerManager().SetTimerForNextTick(
+				FTimerDelegate::CreateUObject(this, &UInventoryComponent::SlotAssetsLoaded));
+		}
+	}
+
+	// Assets requested earlier that are still in flight hold the ready state back until they land
+	if (!Helper_IsLoadingAssets())
+	{
+		Helper_MarkReadyIfLoaded(true);
+	}
+}
+
+
+bool UInventoryComponent::Helper_IsLoadingAssets() const
+{
+	for (const TSharedPtr<FStreamableHandle>& AssetHandle : AssetHandles_)
+	{
+		if (AssetHandle.IsValid() && AssetHandle->IsLoadingInProgress()) { return true; }
+	}
+	return false;
+}
+
+
+/**
+ * Sets bInventoryReady if it was requested and no asset is still loading.
+ * @param bDeferBroadcast If true, OnInventoryReady is broadcast next tick, for callers holding the lock
+ */
+void UInventoryComponent::Helper_MarkReadyIfLoaded(bool bDeferBroadcast)
+{
+	if (!bReadyWhenLoaded_ || bInventoryReady || Helper_IsLoadingAssets()) { return; }
+	bReadyWhenLoaded_	= false;
+	bInventoryReady		= true;
+	if (!bDeferBroadcast)
+	{
+		OnInventoryReady.Broadcast();
+	}
+	else if (IsValid(GetWorld()))
+	{
+		GetWorld()->GetTimerManager().SetTimerForNextTick(FTimerDelegate::CreateWeakLambda(this, [this]()
+		{
+			if (bInventoryReady) { OnInventoryReady.Broadcast(); }
+		}));
+	}
+}
+
+
+/**
+ * Called when a batch of item assets has loaded. Every slot that was still waiting for its
+ * asset is resolved and announced as changed. The inventory becomes ready with the last batch.
+ */
+void UInventoryComponent::SlotAssetsLoaded()
+{
+	{
+		FRWScopeLock WriteLock(InventoryMutex, SLT_Write);
+		INC_DWORD_STAT_BY(STAT_InventorySlotsScanned, InventorySlots_.Num());
+		for (int SlotNumber = 0; SlotNumber < InventorySlots_.Num(); SlotNumber++)
+		{
+			FInventorySlotData& InventorySlot = InventorySlots_[SlotNumber];
+			if (InventorySlot.GetItemName().IsNone() || IsValid(InventorySlot.DataAsset)) { continue; }
+
+			const FInventorySlotData PreviousSlot = InventorySlot;
+			if (!InventorySlot.ResolveDataAsset())
+			{
+				// Either part of a batch that is still loading, or the asset failed to load
+				INVENTORY_DEBUG_LOG(bShowDebug, Log,
+					"{Inventory}({Sv}): Slot #{SlotNum} has no data asset for '{ItemName}' yet",
+					GetName(), HasAuthority()?"SRV":"CLI", SlotNumber, InventorySlot.GetItemName());
+				continue;
+			}
+			Helper_SlotChanged(SlotNumber, PreviousSlot);
+		}
+	}
+	Helper_BroadcastPendingSlotChanges();
+	Helper_MarkReadyIfLoaded(false);
+}
+
+
 //---------------------------------------------------------------------------------------------------------------
 //---------------------------------- REPLICATION ----------------------------------------------------------------
 //---------------------------------------------------------------------------------------------------------------
 
 void UInventoryComponent::OnRep_NewNotification_Implementation()
 {
-	UE_LOGFMT(LogTemp, Log,
+	INVENTORY_DEBUG_LOG(bShowDebug, Log,
 		"{Inventory}({Sv}): New Notification Received. There are now {NumNotifies} notifications pending.",
 		GetName(), HasAuthority()?"SRV":"CLI", Notifications_.Num());
 	OnNotificationAvailable.Broadcast();
@@ -1736,39 +2595,46 @@ void UInventoryComponent::Server_TransferItems_Implementation(
 	UInventoryComponent* OriginInventory, UInventoryComponent* TargetInventory,
 	int OriginSlotNumber, int TargetSlotNumber, int OrderQuantity)
 {
-    UE_LOGFMT(LogTemp, Display, "InventoryComponent: Server_TransferItems_Implementation");
+	INVENTORY_SCOPE_CYCLE_COUNTER(STAT_InventoryTransferItems);
+    INVENTORY_DEBUG_LOG(bShowDebug, Display, "InventoryComponent: Server_TransferItems_Implementation");
 	
     // Validation
     if (!IsValid(OriginInventory)) { OriginInventory = this; }
     if (!IsValid(TargetInventory)) { TargetInventory = this; }
 
-	const bool bNotify = OriginInventory != TargetInventory;
-
-    // Move is from-and-to the exact same slot.. Do nothing.
+	// Slot numbers come from the client. A negative target is the first available slot.
 	UInventorySlot* FromSlot = OriginInventory->GetInventorySlot(OriginSlotNumber);
 	UInventorySlot* ToSlot   = TargetInventory->GetInventorySlot(TargetSlotNumber);
+	if (!IsValid(FromSlot) || (TargetSlotNumber >= 0 && !IsValid(ToSlot)))
+	{
+		UE_LOGFMT(LogInventory, Warning,
+			"{Inventory}({Sv}): Transfer Rejected. Invalid slot number ({FromInv} #{FromSlot} -> {ToInv} #{ToSlot})",
+			GetName(), HasAuthority()?"SRV":"CLI", OriginInventory->GetName(), OriginSlotNumber,
+			TargetInventory->GetName(), TargetSlotNumber);
+		return;
+	}
 
 	const int OriginQuantity = FromSlot->GetQuantity();
-	const int TargetQuantity = ToSlot->GetQuantity();
-	
+
+    // Move is from-and-to the exact same slot.. Do nothing.
     if (FromSlot == ToSlot)
     {
-    	UE_LOGFMT(LogTemp, Log,
+    	INVENTORY_DEBUG_LOG(bShowDebug, Log,
 			"{Inventory}({Sv}): Server_TransferItems() Canceled - Transfer is the exact same slot",
 			GetName(), HasAuthority()?"SRV":"CLI");
 	    return;
     }
 
-	const bool ToSlotLocked		= ToSlot->ContainsTag(TAG_Inventory_Slot_Locked);
-	const bool FromSlotLocked	= ToSlot->ContainsTag(TAG_Inventory_Slot_Locked);
+	const bool ToSlotLocked		= IsValid(ToSlot) && ToSlot->ContainsTag(TAG_Inventory_Slot_Locked);
+	const bool FromSlotLocked	= FromSlot->ContainsTag(TAG_Inventory_Slot_Locked);
 	
 	if (ToSlotLocked || FromSlotLocked)
     {
-    	UE_LOGFMT(LogTemp, Warning,
+    	UE_LOGFMT(LogInventory, Warning,
 			"{Inventory}({Sv}): {InvName}, Slot Number {SlotNum}, is a read-only slot (locked).",
 			GetName(), HasAuthority()?"SRV":"CLI",
-			ToSlotLocked ? ToSlot->GetParentInventory()->GetName() : FromSlot->GetParentInventory()->GetName(),
-			ToSlotLocked ? ToSlot->GetSlotNumber() : FromSlot->GetSlotNumber());
+			ToSlotLocked ? TargetInventory->GetName() : OriginInventory->GetName(),
+			ToSlotLocked ? TargetSlotNumber : OriginSlotNumber);
     	return;
     }
     
@@ -1780,7 +2646,7 @@ void UInventoryComponent::Server_TransferItems_Implementation(
         // The *from* inventory is not this player. The transfer is invalid.
         if (OriginPlayer->IsPlayerControlled() && OriginPlayer != GetOwner())
         {
-        	UE_LOGFMT(LogTemp, Warning,
+        	UE_LOGFMT(LogInventory, Warning,
 				"{Inventory}({Sv}): An attempt to take item from another player's inventory was prevented ({FromInv} -> {ToInv})",
 				GetName(), HasAuthority()?"SRV":"CLI", OriginInventory->GetName(), TargetInventory->GetName());
             return;
@@ -1792,76 +2658,91 @@ void UInventoryComponent::Server_TransferItems_Implementation(
         // The *TO* inventory is not this player. The transfer is invalid.
         if (TargetPlayer->IsPlayerControlled() && TargetPlayer != GetOwner())
         {
-        	UE_LOGFMT(LogTemp, Warning,
+        	UE_LOGFMT(LogInventory, Warning,
 				"{Inventory}({Sv}): An attempt to put items into another player's inventory was prevented ({FromInv} -> {ToInv})",
 				GetName(), HasAuthority()?"SRV":"CLI", OriginInventory->GetName(), TargetInventory->GetName());
             return;
         }
     }
 
-	// Ensure the transfer is within the reach distance of the inventory
-    if (OriginPlayer->GetDistanceTo(TargetPlayer) > MaxInventoryReach_)
+	// Ensure the transfer is within the reach distance of the inventory.
+	// Either side may be a container or any other actor, not just a character.
+	const AActor* OriginActor = OriginInventory->GetOwner();
+	const AActor* TargetActor = TargetInventory->GetOwner();
+    if (IsValid(OriginActor) && IsValid(TargetActor) && OriginActor != TargetActor)
     {
-    	UE_LOGFMT(LogTemp, Error,
-			"{Inventory}({Sv}): Transfer Rejected. Too Far Away ({Distance} (Max: {MaxDistance})",
-			GetName(), HasAuthority()?"SRV":"CLI", OriginPlayer->GetName(),
-			OriginPlayer->GetDistanceTo(TargetPlayer), MaxInventoryReach_);
-    	return;
+    	const float Distance = OriginActor->GetDistanceTo(TargetActor);
+    	if (Distance > MaxInventoryReach_)
+    	{
+    		UE_LOGFMT(LogInventory, Error,
+				"{Inventory}({Sv}): Transfer Rejected. Too Far Away ({Distance} (Max: {MaxDistance})",
+				GetName(), HasAuthority()?"SRV":"CLI", Distance, MaxInventoryReach_);
+    		return;
+    	}
     }
         
 	// Make a copy of the origin item, and decrease it from the origin inventory.
 	// Always TAKE items first to avoid dupe exploits
 	const FItemStatics FromSlotCopy = FromSlot->GetItemStatics();
-	const FItemStatics ToSlotCopy   = ToSlot->GetItemStatics();
-
-	const UEquipmentDataAsset* FromEquipmentItem = FromSlot->GetItemDataAsEquipment();
-	const UEquipmentDataAsset* ToEquipmentItem = ToSlot->GetItemDataAsEquipment();
 
 	// Check if destination slot is an equipment slot and can tolerate the item
-    if (ToSlot->GetIsEquipmentSlot())
+    if (IsValid(ToSlot) && ToSlot->GetIsEquipmentSlot())
     {
-		if ( !ToSlot->ContainsTag(FromEquipmentItem->EquippableSlots) )
+		if ( !ToSlot->GetSlotData().CanEquipItem(FromSlot->GetSlotData().GetItemDefinition()) )
 		{
 			return;
 		}
 	}
 
 	// Validations
-	OrderQuantity = OrderQuantity > 0 ? OrderQuantity : 1;
-    if (!FromSlot->IsEmpty())
-    {
-        // Remove the items from the origin inventory
-        const int itemsRemoved = FromSlot->DecreaseQuantity(OrderQuantity);
-        if (itemsRemoved < 1)
-        {
-        	UE_LOGFMT(LogTemp, Error,
-				"{Inventory}({Sv}): Transfer Failed. "
-				"No items were able to be removed from {FromInv} Slot #{SlotNum}",
-				GetName(), HasAuthority()?"SRV":"CLI", OriginInventory->GetName(), OriginSlotNumber);
-            return;
-        }
-    	OrderQuantity = itemsRemoved;
-    }
-    
-    // If decrease was successful (or slot is empty), add it to the destination inventory.
-    const int itemsAdded = TargetInventory->AddItem(FromSlot, OrderQuantity, TargetSlotNumber,
-    	false, false, bNotify);
-    if (itemsAdded > 0)
+	OrderQuantity = FMath::Min(OrderQuantity > 0 ? OrderQuantity : 1, OriginQuantity);
+    if (FromSlot->IsEmpty())
     {
-    	// obsolete..?
+    	UE_LOGFMT(LogInventory, Error,
+			"{Inventory}({Sv}): Transfer Failed. {FromInv} Slot #{SlotNum} is empty",
+			GetName(), HasAuthority()?"SRV":"CLI", OriginInventory->GetName(), OriginSlotNumber);
+        return;
     }
-    
-    // If the add failed, reinstate the item to the origin inventory
-	// If the original from slot and current from slots quantities don't match, reimburse the items
-    else if (OriginQuantity != FromSlot->GetQuantity())
-    {
-    	UE_LOGFMT(LogTemp, Error,
+
+	// Both sides change together, so a failed add can never lose or duplicate the items
+	FInventoryTransaction OriginTransaction(OriginInventory);
+	TOptional<FInventoryTransaction> TargetTransaction;
+	if (TargetInventory != OriginInventory)
+	{
+		TargetTransaction.Emplace(TargetInventory);
+	}
+	FInventoryTransaction& ReceivingTransaction = TargetTransaction.IsSet()
+		? TargetTransaction.GetValue() : OriginTransaction;
+
+	// Take the items first, then return whatever did not fit the destination
+	const int itemsRemoved	= OriginTransaction.RemoveFromSlot(OriginSlotNumber, OrderQuantity);
+	const int itemsAdded	= itemsRemoved > 0
+		? ReceivingTransaction.AddItem(FromSlotCopy, itemsRemoved, TargetSlotNumber, false, false,
+			TargetTransaction.IsSet() ? -1 : OriginSlotNumber) : -1;
+	if (itemsAdded > 0 && itemsAdded < itemsRemoved)
+	{
+		OriginTransaction.SetSlotItem(OriginSlotNumber, FromSlotCopy,
+			FromSlot->GetQuantity() + itemsRemoved - itemsAdded);
+	}
+
+	const bool bTransferred = itemsAdded > 0
+		&& !OriginTransaction.HasFailed() && !ReceivingTransaction.HasFailed();
+	if (!bTransferred)
+	{
+		OriginTransaction.Fail();
+		ReceivingTransaction.Fail();
+		UE_LOGFMT(LogInventory, Error,
 			"{Inventory}({Sv}): Transfer Failed. "
-			"No items were able to be added to '{ToInv} Slot Number #{SlotNum}'"
-			" from '{FromInv}' Slot Number #{FromSlot}... Will attempt to reimburse loss.",
+			"No items were able to be moved to '{ToInv} Slot Number #{SlotNum}'"
+			" from '{FromInv}' Slot Number #{FromSlot}",
 			GetName(), HasAuthority()?"SRV":"CLI", TargetInventory->GetName(), TargetSlotNumber,
 			OriginInventory->GetName(), OriginSlotNumber);
-    }
+	}
+	if (TargetTransaction.IsSet())
+	{
+		TargetTransaction->Commit();
+	}
+	OriginTransaction.Commit();
 }
 
 
@@ -1889,7 +2770,7 @@ void UInventoryComponent::Server_DropItemOnGround_Implementation(
 	
 	if (FromSlot == nullptr)
 	{
-		UE_LOGFMT(LogTemp, Warning,
+		UE_LOGFMT(LogInventory, Warning,
 			"{Inventory}({Sv}): Attempted to drop item from {FromInv} Slot #{SlotNum}, "
 			"but the slot is Empty (or Invalid)", GetName(), HasAuthority()?"SRV":"CLI",
 			OriginInventory->GetName(), SlotNumber);
@@ -1900,7 +2781,7 @@ void UInventoryComponent::Server_DropItemOnGround_Implementation(
 	USkeletalMeshComponent* thisMesh = OwningCharacter->GetMesh();
 	if (!IsValid(thisMesh))
 	{
-		UE_LOGFMT(LogTemp, Error,
+		UE_LOGFMT(LogInventory, Error,
 			"{Inventory}({Sv}): Attempt to Drop Failed. Dropping player has no GetMesh().",
 			GetName(), HasAuthority()?"SRV":"CLI");
 		return;
@@ -1918,17 +2799,14 @@ void UInventoryComponent::Server_DropItemOnGround_Implementation(
 	const FItemStatics ItemCopy	= InventorySlot->GetItemStatics();
 	const int itemsRemoved	= InventorySlot->DecreaseQuantity(OrderQuantity);
 
+	// Nothing was taken when nothing was removed, so there is nothing to give back either
 	if (itemsRemoved > 0)
 	{
 		APickupActorBase* pickupItem = GetWorld()->SpawnActorDeferred<APickupActorBase>(
 											APickupActorBase::StaticClass(), spawnTransform);
-		pickupItem->SetupItem(ItemCopy);
+		pickupItem->SetupItem(ItemCopy, itemsRemoved);
 		pickupItem->FinishSpawning(spawnTransform);
 	}
-	else
-	{
-		OriginInventory->AddItem(FromSlot, OrderQuantity, SlotNumber);
-	}
 }
 
 /**
@@ -1949,7 +2827,7 @@ void UInventoryComponent::Server_RequestOtherInventory_Implementation(UInventory
 		if (targetInventory == this)
 		{
 			const APlayerState* thisPlayerState = OwnerCharacter->GetPlayerState();
-			UE_LOGFMT(LogTemp, Display, "{Inventory}({Sv}): Attempt to request players own inventory denied.",
+			INVENTORY_DEBUG_LOG(bShowDebug, Display, "{Inventory}({Sv}): Attempt to request players own inventory denied.",
 				IsValid(thisPlayerState) ? thisPlayerState->GetPlayerId() : 0);
 			return;
 		}
@@ -1967,23 +2845,83 @@ void UInventoryComponent::Server_RequestOtherInventory_Implementation(UInventory
     		// Is the character controlled by the player?
     		if (IsValid( Cast<APlayerController>(TargetController) ))
     		{
-    			UE_LOGFMT(LogTemp, Display, "{Inventory}({Sv}): RequestOtherInventory() - "
+    			INVENTORY_DEBUG_LOG(bShowDebug, Display, "{Inventory}({Sv}): RequestOtherInventory() - "
 					"{ThisPlayer} was denied access to the inventory of {TargetPlayer}",
 					GetName(), HasAuthority()?"SRV":"CLI", OwnerCharacter->GetName(), TargetCharacter->GetName());
     			return;
     		}
 
     		// Character is controlled by an NPC
-    		UE_LOGFMT(LogTemp, Display, "{Inventory}({Sv}): RequestOtherInventory() - "
+    		INVENTORY_DEBUG_LOG(bShowDebug, Display, "{Inventory}({Sv}): RequestOtherInventory() - "
 				"{ThisPlayer} was denied access to the inventory of {TargetPlayer} - NPC is still controlled (alive)",
 				GetName(), HasAuthority()?"SRV":"CLI", OwnerCharacter->GetName(), TargetCharacter->GetName());
     		return;
     	}
     }
 	
-	UE_LOGFMT(LogTemp, Display, "{Inventory}({Sv}): Request to access '{TargetInventory}' of {TargetName} was successful",
-			  GetName(), HasAuthority()?"SRV":"CLI", targetInventory->GetName(), TargetCharacter->GetName());
-    
+	INVENTORY_DEBUG_LOG(bShowDebug, Display, "{Inventory}({Sv}): Request to access '{TargetInventory}' of {TargetName} was successful",
+			  GetName(), HasAuthority()?"SRV":"CLI", targetInventory->GetName(), GetNameSafe(TargetActor));
+
+	if (IsValid(OwnerCharacter))
+	{
+		targetInventory->AddViewer( Cast<APlayerController>(OwnerCharacter->GetController()) );
+	}
+}
+
+void UInventoryComponent::Server_CloseOtherInventory_Implementation(UInventoryComponent* targetInventory)
+{
+	const ACharacter* OwnerCharacter = Cast<ACharacter>( GetOwner() );
+	if (IsValid(targetInventory) && targetInventory != this && IsValid(OwnerCharacter))
+	{
+		targetInventory->RemoveViewer( Cast<APlayerController>(OwnerCharacter->GetController()) );
+	}
+}
+
+/**
+ * Adds the player's connection to the viewer set. When the inventory only replicates
+ * to viewers, the player receives the slot contents from the next net update on.
+ * @param Viewer The player that opened this inventory
+ */
+void UInventoryComponent::AddViewer(const APlayerController* Viewer)
+{
+	if (!HasAuthority() || !IsValid(Viewer)) { return; }
+	UNetConnection* ViewerConnection = Viewer->GetNetConnection();
+	if (!IsValid(ViewerConnection)) { return; }
+
+	Viewers_.RemoveAll([](const TWeakObjectPtr<UNetConnection>& Connection) { return !Connection.IsValid(); });
+	if (!IsSlotViewer(ViewerConnection))
+	{
+		Viewers_.Add(ViewerConnection);
+
+		// Push model would otherwise skip the slots until their next change
+		MARK_INVENTORY_PROPERTY_DIRTY(UInventoryComponent, InventorySlots_);
+	}
+}
+
+/**
+ * Removes the player's connection from the viewer set.
+ * @param Viewer The player that closed this inventory
+ */
+void UInventoryComponent::RemoveViewer(const APlayerController* Viewer)
+{
+	if (!HasAuthority() || !IsValid(Viewer)) { return; }
+	const UNetConnection* ViewerConnection = Viewer->GetNetConnection();
+	Viewers_.RemoveAll([ViewerConnection](const TWeakObjectPtr<UNetConnection>& Connection)
+	{
+		return !Connection.IsValid() || Connection.Get() == ViewerConnection;
+	});
+}
+
+bool UInventoryComponent::IsSlotViewer(const UNetConnection* Connection) const
+{
+	if (!bReplicateToViewersOnly || Connection == nullptr) { return true; }
+
+	// The owner always sees their own inventory
+	if (IsValid(GetOwner()) && GetOwner()->GetNetConnection() == Connection) { return true; }
+	return Viewers_.ContainsByPredicate([Connection](const TWeakObjectPtr<UNetConnection>& Viewer)
+	{
+		return Viewer.Get() == Connection;
+	});
 }
 
 
@@ -1995,7 +2933,18 @@ void UInventoryComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty> &
 {
     Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-    DOREPLIFETIME(UInventoryComponent, InventorySlots_);
-	
-    DOREPLIFETIME_CONDITION(UInventoryComponent, Notifications_, COND_OwnerOnly);
+	FDoRepLifetimeParams PushParams;
+	PushParams.bIsPushBased = true;
+    DOREPLIFETIME_WITH_PARAMS_FAST(UInventoryComponent, InventorySlots_, PushParams);
+
+    DOREPLIFETIME_WITH_PARAMS_FAST(UInventoryComponent, bContainsItems_, PushParams);
+
+	PushParams.Condition = COND_OwnerOnly;
+    DOREPLIFETIME_WITH_PARAMS_FAST(UInventoryComponent, Notifications_, PushParams);
+}
+
+void UInventoryComponent::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+	Super::PreReplication(ChangedPropertyTracker);
+	COUNT_INVENTORY_PUSH_COMPARES_AVOIDED(NumPushProperties);
 }
\ No newline at end of file
@@ -0,0 +1,523 @@
+
+#include "InventoryPersistenceSubsystem.h"
+
+#include "InventoryComponent.h"
+#include "InventoryLog.h"
+#include "InventoryStats.h"
+#include "Async/Async.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+/*
+ * Store layout. The file is only ever appended to, except when it is compacted, or cut back to
+ * its last intact record before the first append of a session and after a failed append.
+ *
+ *   { uint32 Magic, uint8 RecordType, FString InventoryId, TArray<uint8> Payload }...
+ *
+ * The payload of a full record is the compact slot format of UInventorySave::EncodeInventorySlots,
+ * compressed with 'StoreCompression' when it is set (see UInventorySave::CompressPayload).
+ * A delta record is a packed count and slot numbers, followed by the same format holding just
+ * those slots in that order. An inventory is restored from its latest full record and every
+ * delta record after it.
+ */
+
+namespace
+{
+	constexpr uint32 StoreRecordMagic = 0x52494735; // '5GIR'
+
+	enum class EStoreRecordType : uint8
+	{
+		Full = 0,
+		Delta = 1,
+	};
+
+	void EncodeStoreRecord(FArchive& Ar, const FInventoryStoreRecord& Record, EInventorySaveCompression Compression)
+	{
+		uint32 Magic		= StoreRecordMagic;
+		uint8 RecordType	= static_cast<uint8>(Record.bFullRecord ? EStoreRecordType::Full : EStoreRecordType::Delta);
+		FString InventoryId	= Record.InventoryId;
+
+		TArray<uint8> Payload;
+		if (Record.bFullRecord)
+		{
+			UInventorySave::EncodeInventorySlots(Record.InventorySlots, Payload);
+			UInventorySave::CompressPayload(Payload, Compression);
+		}
+		else
+		{
+			FMemoryWriter PayloadWriter(Payload);
+			uint32 NumChanged = Record.SlotNumbers.Num();
+			PayloadWriter.SerializeIntPacked(NumChanged);
+			for (const int SlotNumber : Record.SlotNumbers)
+			{
+				uint32 PackedSlotNumber = SlotNumber;
+				PayloadWriter.SerializeIntPacked(PackedSlotNumber);
+			}
+			TArray<uint8> SlotBytes;
+			UInventorySave::EncodeInventorySlots(Record.InventorySlots, SlotBytes);
+			UInventorySave::CompressPayload(SlotBytes, Compression);
+			PayloadWriter.Serialize(SlotBytes.GetData(), SlotBytes.Num());
+		}
+
+		Ar << Magic;
+		Ar << RecordType;
+		Ar << InventoryId;
+		Ar << Payload;
+	}
+
+	// Applies a delta payload on top of the slots restored so far
+	bool ApplyDeltaPayload(const TArray<uint8>& Payload, TArray<FInventorySlotSaveData>& InventorySlots)
+	{
+		FMemoryReader PayloadReader(Payload);
+		uint32 NumChanged = 0;
+		PayloadReader.SerializeIntPacked(NumChanged);
+		if (PayloadReader.IsError() || NumChanged > static_cast<uint32>(InventorySlots.Num())) { return false; }
+
+		TArray<uint32> SlotNumbers;
+		SlotNumbers.SetNum(NumChanged);
+		for (uint32& SlotNumber : SlotNumbers)
+		{
+			PayloadReader.SerializeIntPacked(SlotNumber);
+			if (SlotNumber >= static_cast<uint32>(InventorySlots.Num())) { return false; }
+		}
+		if (PayloadReader.IsError()) { return false; }
+
+		const TArray<uint8> SlotBytes(Payload.GetData() + PayloadReader.Tell(), Payload.Num() - PayloadReader.Tell());
+		TArray<FInventorySlotSaveData> ChangedSlots;
+		if (!UInventorySave::DecodeInventorySlots(SlotBytes, ChangedSlots) || ChangedSlots.Num() != SlotNumbers.Num())
+		{
+			return false;
+		}
+		for (int i = 0; i < ChangedSlots.Num(); i++)
+		{
+			InventorySlots[SlotNumbers[i]] = MoveTemp(ChangedSlots[i]);
+		}
+		return true;
+	}
+
+	/**
+	 * Reads the record headers from the start of the store, skipping the payloads.
+	 * Stops at the first damaged record, which a crash or a failed write leaves behind.
+	 * @return The end of the last intact record, which is the file size if none is damaged
+	 */
+	int64 ScanStoreRecords(FArchive& FileReader, TFunctionRef<void(const FInventoryStoreWrittenRecord&)> OnRecord)
+	{
+		const int64 FileSize = FileReader.TotalSize();
+		int64 IntactSize = 0;
+		while (IntactSize < FileSize)
+		{
+			FInventoryStoreWrittenRecord Record;
+			Record.Span.Offset	= IntactSize;
+			uint32 Magic		= 0;
+			uint8 RecordType	= 0;
+			int32 PayloadSize	= 0;
+			FileReader.Seek(IntactSize);
+			FileReader << Magic;
+			FileReader << RecordType;
+			FileReader << Record.InventoryId;
+			FileReader << PayloadSize;
+			if (FileReader.IsError() || Magic != StoreRecordMagic || PayloadSize < 0
+				|| FileReader.Tell() + PayloadSize > FileSize)
+			{
+				break;
+			}
+			IntactSize			= FileReader.Tell() + PayloadSize;
+			Record.Span.Size	= IntactSize - Record.Span.Offset;
+			Record.bFullRecord	= RecordType == static_cast<uint8>(EStoreRecordType::Full);
+			OnRecord(Record);
+		}
+		return IntactSize;
+	}
+
+	/**
+	 * Runs on a background thread. Appends the whole batch in a single write.
+	 * With bTruncateDamaged, the store is first cut back to its last intact record, so records
+	 * appended now are not hidden behind a record torn by a crash or by an earlier failed write.
+	 * A failed write is cut back off the store as well.
+	 */
+	FInventoryStoreTaskResult AppendStoreRecords(const FString& StorePath, TArray<FInventoryStoreRecord> Records,
+		EInventorySaveCompression Compression, bool bTruncateDamaged)
+	{
+		FInventoryStoreTaskResult Result;
+		TArray<uint8> Batch;
+		FMemoryWriter BatchWriter(Batch);
+		for (const FInventoryStoreRecord& Record : Records)
+		{
+			FInventoryStoreWrittenRecord& Written = Result.Records.AddDefaulted_GetRef();
+			Written.InventoryId		= Record.InventoryId;
+			Written.bFullRecord		= Record.bFullRecord;
+			Written.Span.Offset		= Batch.Num();
+			EncodeStoreRecord(BatchWriter, Record, Compression);
+			Written.Span.Size		= Batch.Num() - Written.Span.Offset;
+		}
+
+		int64 StartOffset = FMath::Max<int64>(IFileManager::Get().FileSize(*StorePath), 0);
+		if (bTruncateDamaged && StartOffset > 0)
+		{
+			const TUniquePtr<FArchive> FileReader( IFileManager::Get().CreateFileReader(*StorePath) );
+			if (FileReader.IsValid())
+			{
+				const int64 IntactSize = ScanStoreRecords(*FileReader, [](const FInventoryStoreWrittenRecord&) {});
+				if (IntactSize < StartOffset)
+				{
+					UE_LOGFMT(LogInventory, Warning,
+						"InventoryPersistence: Truncating a damaged record at offset {Offset} of '{Store}'",
+						IntactSize, StorePath);
+				}
+				StartOffset = IntactSize;
+			}
+		}
+
+		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+		PlatformFile.CreateDirectoryTree(*FPaths::GetPath(StorePath));
+		const TUniquePtr<IFileHandle> FileHandle( PlatformFile.OpenWrite(*StorePath, true, true) );
+		if (FileHandle.IsValid())
+		{
+			Result.bSuccess = FileHandle->Truncate(StartOffset) && FileHandle->Seek(StartOffset)
+				&& FileHandle->Write(Batch.GetData(), Batch.Num()) && FileHandle->Flush();
+			if (!Result.bSuccess)
+			{
+				// Leaves the store ending on an intact record. If even that fails, the next append truncates it.
+				Result.bStoreIntact = FileHandle->Truncate(StartOffset);
+			}
+		}
+		if (!Result.bSuccess)
+		{
+			Result.Records.Empty();
+			Result.FailedRecords = MoveTemp(Records);
+			return Result;
+		}
+
+		for (FInventoryStoreWrittenRecord& Written : Result.Records)
+		{
+			Written.Span.Offset += StartOffset;
+		}
+		return Result;
+	}
+
+	// Runs on a background thread. Copies the live records into a new file, which then replaces the store.
+	FInventoryStoreTaskResult CompactStore(const FString& StorePath, const TMap<FString, TArray<FInventoryStoreSpan>>& StoreIndex)
+	{
+		FInventoryStoreTaskResult Result;
+		Result.bCompaction = true;
+
+		const FString CompactedPath = StorePath + TEXT(".compact");
+		{
+			const TUniquePtr<FArchive> FileReader( IFileManager::Get().CreateFileReader(*StorePath) );
+			const TUniquePtr<FArchive> FileWriter( IFileManager::Get().CreateFileWriter(*CompactedPath) );
+			if (!FileReader.IsValid() || !FileWriter.IsValid()) { return Result; }
+
+			TArray<uint8> RecordBytes;
+			for (const TPair<FString, TArray<FInventoryStoreSpan>>& Entry : StoreIndex)
+			{
+				for (int i = 0; i < Entry.Value.Num(); i++)
+				{
+					const FInventoryStoreSpan& Span = Entry.Value[i];
+					RecordBytes.SetNumUninitialized(Span.Size);
+					FileReader->Seek(Span.Offset);
+					FileReader->Serialize(RecordBytes.GetData(), Span.Size);
+
+					FInventoryStoreWrittenRecord& Written = Result.Records.AddDefaulted_GetRef();
+					Written.InventoryId	= Entry.Key;
+					Written.bFullRecord	= i == 0;
+					Written.Span		= { FileWriter->Tell(), Span.Size };
+					FileWriter->Serialize(RecordBytes.GetData(), Span.Size);
+				}
+			}
+			if (FileReader->IsError() || !FileWriter->Close()) { return Result; }
+		}
+
+		Result.bSuccess = IFileManager::Get().Move(*StorePath, *CompactedPath, true);
+		return Result;
+	}
+}
+
+
+bool UInventoryPersistenceSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+
+void UInventoryPersistenceSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+	if (FlushInterval > 0.f)
+	{
+		InWorld.GetTimerManager().SetTimer(FlushTimer_, this, &UInventoryPersistenceSubsystem::Flush, FlushInterval, true);
+	}
+}
+
+
+void UInventoryPersistenceSubsystem::Deinitialize()
+{
+	// Anything still dirty would be lost with the world. A finished write may start a compaction.
+	while (PendingWrite_.IsValid())
+	{
+		Helper_FinishPendingWrite(true);
+	}
+	Flush();
+	while (PendingWrite_.IsValid())
+	{
+		Helper_FinishPendingWrite(true);
+	}
+	Super::Deinitialize();
+}
+
+
+FString UInventoryPersistenceSubsystem::GetStorePath() const
+{
+	return FPaths::ProjectSavedDir() / TEXT("SaveGames") / StoreName;
+}
+
+
+void UInventoryPersistenceSubsystem::MarkInventoryDirty(UInventoryComponent* Inventory)
+{
+	if (IsValid(Inventory))
+	{
+		DirtyInventories_.Add(Inventory);
+	}
+}
+
+
+void UInventoryPersistenceSubsystem::ReleaseInventory(UInventoryComponent* Inventory)
+{
+	if (!IsValid(Inventory) || !DirtyInventories_.Contains(Inventory)) { return; }
+	DirtyInventories_.Remove(Inventory);
+
+	// The dirty set only holds a weak pointer, so the record has to be taken while it still resolves
+	FInventoryStoreRecord Record;
+	Record.Inventory = Inventory;
+	if (Inventory->Helper_GetPersistenceRecord(Record, MaxDeltaRecords))
+	{
+		ReleasedRecords_.Add(MoveTemp(Record));
+	}
+}
+
+
+/**
+ * Copies the changed slots of every dirty inventory and hands them to a background task,
+ * which encodes them and appends them to the store in a single write.
+ */
+void UInventoryPersistenceSubsystem::Flush()
+{
+	Helper_FinishPendingWrite(false);
+	if (PendingWrite_.IsValid() || (DirtyInventories_.IsEmpty() && ReleasedRecords_.IsEmpty())) { return; }
+
+	TArray<FInventoryStoreRecord> Records = MoveTemp(ReleasedRecords_);
+	ReleasedRecords_.Reset();
+	Records.Reserve(Records.Num() + DirtyInventories_.Num());
+	for (const TWeakObjectPtr<UInventoryComponent>& DirtyInventory : DirtyInventories_)
+	{
+		UInventoryComponent* Inventory = DirtyInventory.Get();
+		if (!IsValid(Inventory)) { continue; }
+
+		FInventoryStoreRecord Record;
+		Record.Inventory = Inventory;
+		if (Inventory->Helper_GetPersistenceRecord(Record, MaxDeltaRecords))
+		{
+			Records.Add(MoveTemp(Record));
+		}
+	}
+	DirtyInventories_.Empty();
+	if (Records.IsEmpty()) { return; }
+
+	UE_LOGFMT(LogInventory, Log, "InventoryPersistence: Writing {Num} inventories to '{Store}'", Records.Num(), StoreName);
+	for (const FInventoryStoreRecord& Record : Records)
+	{
+		PendingWriteIds_.Add(Record.InventoryId);
+	}
+	PendingWrite_ = Async(EAsyncExecution::ThreadPool,
+		[StorePath = GetStorePath(), Records = MoveTemp(Records), Compression = StoreCompression,
+			bTruncateDamaged = !bStoreIntact_]() mutable
+		{
+			return AppendStoreRecords(StorePath, MoveTemp(Records), Compression, bTruncateDamaged);
+		});
+}
+
+
+void UInventoryPersistenceSubsystem::Helper_FinishPendingWrite(bool bWait)
+{
+	if (!PendingWrite_.IsValid()) { return; }
+	if (!bWait && !PendingWrite_.IsReady()) { return; }
+
+	FInventoryStoreTaskResult Result = PendingWrite_.Get();
+	PendingWrite_.Reset();
+	PendingWriteIds_.Empty();
+	bPendingCompaction_ = false;
+
+	// A compaction writes a new file, so a failed one leaves the store as it was
+	if (!Result.bCompaction)
+	{
+		bStoreIntact_ = Result.bSuccess || Result.bStoreIntact;
+	}
+	if (!Result.bSuccess)
+	{
+		UE_LOGFMT(LogInventory, Warning, "InventoryPersistence: Failed to {Task} '{Store}'",
+			Result.bCompaction ? "compact" : "write to", StoreName);
+
+		// The deltas are gone, so the next record of these inventories has to stand on its own.
+		// Inventories that already ended play cannot write a new one, so their record is retried.
+		for (FInventoryStoreRecord& FailedRecord : Result.FailedRecords)
+		{
+			if (UInventoryComponent* Inventory = FailedRecord.Inventory.Get())
+			{
+				Inventory->Helper_PersistenceFailed();
+			}
+			else
+			{
+				ReleasedRecords_.Add(MoveTemp(FailedRecord));
+			}
+		}
+		return;
+	}
+
+	if (Result.bCompaction)
+	{
+		StoreIndex_.Empty();
+		LiveStoreSize_	= 0;
+		StoreSize_		= 0;
+	}
+
+	// Before the index is built, the scan will pick these up from the file
+	if (bStoreIndexBuilt_)
+	{
+		for (const FInventoryStoreWrittenRecord& Written : Result.Records)
+		{
+			Helper_AddToStoreIndex(Written);
+		}
+	}
+	if (!Result.bCompaction)
+	{
+		Helper_CompactIfNeeded();
+	}
+}
+
+
+void UInventoryPersistenceSubsystem::Helper_AddToStoreIndex(const FInventoryStoreWrittenRecord& Record)
+{
+	TArray<FInventoryStoreSpan>& Spans = StoreIndex_.FindOrAdd(Record.InventoryId);
+	if (Record.bFullRecord)
+	{
+		for (const FInventoryStoreSpan& Span : Spans)
+		{
+			LiveStoreSize_ -= Span.Size;
+		}
+		Spans.Reset();
+	}
+
+	// A delta without a full record before it has nothing to apply to
+	if (Record.bFullRecord || !Spans.IsEmpty())
+	{
+		Spans.Add(Record.Span);
+		LiveStoreSize_ += Record.Span.Size;
+	}
+	if (Spans.IsEmpty())
+	{
+		StoreIndex_.Remove(Record.InventoryId);
+	}
+	StoreSize_ = FMath::Max(StoreSize_, Record.Span.Offset + Record.Span.Size);
+}
+
+
+void UInventoryPersistenceSubsystem::Helper_CompactIfNeeded()
+{
+	if (PendingWrite_.IsValid()) { return; }
+	if (!bStoreIndexBuilt_)
+	{
+		// Only pay for the scan once the store is big enough to be worth compacting
+		if (IFileManager::Get().FileSize(*GetStorePath()) < MinCompactionSize) { return; }
+		Helper_BuildStoreIndex();
+	}
+	if (StoreSize_ < MinCompactionSize || StoreSize_ < LiveStoreSize_ * CompactionRatio) { return; }
+
+	UE_LOGFMT(LogInventory, Log, "InventoryPersistence: Compacting '{Store}' ({Live} of {Size} bytes are live)",
+		StoreName, LiveStoreSize_, StoreSize_);
+	bPendingCompaction_ = true;
+	PendingWrite_ = Async(EAsyncExecution::ThreadPool,
+		[StorePath = GetStorePath(), StoreIndex = StoreIndex_]()
+		{
+			return CompactStore(StorePath, StoreIndex);
+		});
+}
+
+
+void UInventoryPersistenceSubsystem::Helper_BuildStoreIndex()
+{
+	bStoreIndexBuilt_ = true;
+	StoreIndex_.Empty();
+	LiveStoreSize_	= 0;
+	StoreSize_		= 0;
+
+	const TUniquePtr<FArchive> FileReader( IFileManager::Get().CreateFileReader(*GetStorePath()) );
+	if (!FileReader.IsValid()) { return; }
+
+	// Appends cut the store back to its last intact record first, so damage can only be at the end
+	const int64 IntactSize = ScanStoreRecords(*FileReader,
+		[this](const FInventoryStoreWrittenRecord& Record) { Helper_AddToStoreIndex(Record); });
+	if (IntactSize < FileReader->TotalSize())
+	{
+		UE_LOGFMT(LogInventory, Warning, "InventoryPersistence: '{Store}' has a damaged record at offset {Offset}",
+			StoreName, IntactSize);
+	}
+}
+
+
+/**
+ * Restores the inventory from its latest full record and the delta records after it.
+ * @param InventoryId The persistence id of the inventory (its save slot name)
+ * @param OutInventorySlots The restored slots, one-for-one with the saved inventory
+ * @return True if a valid record was found
+ */
+bool UInventoryPersistenceSubsystem::LoadInventorySlots(
+	const FString& InventoryId, TArray<FInventorySlotSaveData>& OutInventorySlots)
+{
+	// Appends of other ids leave the offsets of this one intact. A compaction moves every record,
+	// and the index scan could read a record the write has only half appended.
+	// A finished write may start a compaction.
+	while (PendingWrite_.IsValid()
+		&& (bPendingCompaction_ || !bStoreIndexBuilt_ || PendingWriteIds_.Contains(InventoryId)))
+	{
+		INVENTORY_SCOPE_CYCLE_COUNTER(STAT_InventoryStoreWriteWait);
+		Helper_FinishPendingWrite(true);
+	}
+	if (!bStoreIndexBuilt_)
+	{
+		Helper_BuildStoreIndex();
+	}
+
+	const TArray<FInventoryStoreSpan>* Spans = StoreIndex_.Find(InventoryId);
+	if (Spans == nullptr || Spans->IsEmpty()) { return false; }
+
+	const TUniquePtr<FArchive> FileReader( IFileManager::Get().CreateFileReader(*GetStorePath()) );
+	if (!FileReader.IsValid()) { return false; }
+
+	for (int i = 0; i < Spans->Num(); i++)
+	{
+		FileReader->Seek((*Spans)[i].Offset);
+		uint32 Magic		= 0;
+		uint8 RecordType	= 0;
+		FString RecordId;
+		TArray<uint8> Payload;
+		*FileReader << Magic;
+		*FileReader << RecordType;
+		*FileReader << RecordId;
+		*FileReader << Payload;
+
+		const EStoreRecordType ExpectedType = i == 0 ? EStoreRecordType::Full : EStoreRecordType::Delta;
+		if (FileReader->IsError() || Magic != StoreRecordMagic || RecordId != InventoryId
+			|| RecordType != static_cast<uint8>(ExpectedType))
+		{
+			return false;
+		}
+
+		const bool bApplied = i == 0
+			? UInventorySave::DecodeInventorySlots(Payload, OutInventorySlots)
+			: ApplyDeltaPayload(Payload, OutInventorySlots);
+		if (!bApplied) { return false; }
+	}
+	return true;
+}
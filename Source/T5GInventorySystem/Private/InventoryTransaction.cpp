@@ -0,0 +1,244 @@
+#include "InventoryTransaction.h"
+
+#include "InventoryComponent.h"
+#include "InventoryLog.h"
+#include "InventoryStats.h"
+#include "lib/ItemData.h"
+
+
+FInventoryTransaction::FInventoryTransaction(UInventoryComponent* InInventory)
+	: Inventory_(InInventory)
+{
+	if (!IsValid(Inventory_))
+	{
+		UE_LOGFMT(LogInventory, Error, "InventoryTransaction: Failed to begin - Invalid Inventory");
+		Inventory_ = nullptr;
+		bFailed_ = true;
+		return;
+	}
+	if (Inventory_->ActiveTransaction_ != nullptr)
+	{
+		// The mutex is not recursive, so a nested transaction would lock up the game thread
+		UE_LOGFMT(LogInventory, Error,
+			"{Inventory}({Sv}): InventoryTransaction Failed - A transaction is already active",
+			Inventory_->GetName(), Inventory_->HasAuthority()?"SRV":"CLI");
+		bFailed_ = true;
+		return;
+	}
+	Inventory_->InventoryMutex.WriteLock();
+	Inventory_->ActiveTransaction_ = this;
+	bLocked_ = true;
+}
+
+
+FInventoryTransaction::~FInventoryTransaction()
+{
+	if (bLocked_)
+	{
+		Rollback();
+	}
+}
+
+
+int FInventoryTransaction::AddItem(const FItemStatics& ItemStatics, int OrderQuantity, int SlotNumber,
+	bool bAddOverflow, bool bAllOrNothing, int SkipSlotNumber)
+{
+	if (!bLocked_ || ItemStatics.ItemName.IsNone() || OrderQuantity < 1)
+	{
+		bFailed_ = true;
+		return -1;
+	}
+
+	// The plan reads the stack size from the asset registry, so a missing asset is only requested
+	const UItemDataAsset* ItemData = Inventory_->Helper_RequestItemData(ItemStatics);
+	FInventoryAddPlan Plan;
+	Inventory_->Helper_PlanAddItem(ItemStatics, OrderQuantity, SlotNumber, bAddOverflow, Plan, SkipSlotNumber);
+	if (Plan.Remainder > 0 && bAllOrNothing)
+	{
+		INVENTORY_DEBUG_LOG(Inventory_->GetInventoryDebugMode(), Display,
+			"{Inventory}({Sv}): InventoryTransaction AddItem Failed - "
+			"Only {NumFit} of {NumRequest} '{ItemName}' fit",
+			Inventory_->GetName(), Inventory_->HasAuthority()?"SRV":"CLI",
+			OrderQuantity - Plan.Remainder, OrderQuantity, ItemStatics.ItemName);
+		bFailed_ = true;
+		return -1;
+	}
+
+	int ItemsAdded = 0;
+	for (const FInventoryAddPlan::FPlacement& Placement : Plan.Placements)
+	{
+		const FInventorySlotData& TargetSlot = Inventory_->InventorySlots_[Placement.SlotNumber];
+		const int OldQuantity = TargetSlot.IsEmpty() ? 0 : TargetSlot.Quantity;
+		const int NewQuantity = OldQuantity == 0
+			? Inventory_->Helper_SetSlotItem(Placement.SlotNumber, ItemStatics, Placement.Quantity, ItemData)
+			: Inventory_->Helper_SetSlotQuantity(Placement.SlotNumber, OldQuantity + Placement.Quantity);
+		ItemsAdded += FMath::Max(NewQuantity - OldQuantity, 0);
+	}
+	return ItemsAdded;
+}
+
+
+int FInventoryTransaction::RemoveItem(
+	const FName& ItemName, int OrderQuantity, bool bRemoveEquipment, bool bAllOrNothing)
+{
+	if (!bLocked_ || ItemName.IsNone() || OrderQuantity < 1)
+	{
+		bFailed_ = true;
+		return -1;
+	}
+
+	// Copied, since emptying a slot removes it from the index entry
+	TArray<int, TInlineAllocator<4>> MatchingSlots;
+	if (const FInventoryItemIndexEntry* IndexEntry = Inventory_->ItemIndex_.Find(ItemName))
+	{
+		MatchingSlots = IndexEntry->SlotNumbers;
+	}
+	INC_DWORD_STAT_BY(STAT_InventorySlotsScanned, MatchingSlots.Num());
+
+	int RemainingQuantity = OrderQuantity;
+	for (const int MatchingSlot : MatchingSlots)
+	{
+		if (RemainingQuantity < 1) { break; }
+		if (MatchingSlot >= Inventory_->EquipmentSlotsStart_ && !bRemoveEquipment) { continue; }
+
+		const int OldQuantity = Inventory_->InventorySlots_[MatchingSlot].Quantity;
+		const int NewQuantity = Inventory_->Helper_SetSlotQuantity(
+			MatchingSlot, OldQuantity - FMath::Min(OldQuantity, RemainingQuantity));
+		if (NewQuantity >= 0) { RemainingQuantity -= OldQuantity - NewQuantity; }
+	}
+
+	const int ItemsRemoved = OrderQuantity - RemainingQuantity;
+	if (RemainingQuantity > 0 && bAllOrNothing)
+	{
+		INVENTORY_DEBUG_LOG(Inventory_->GetInventoryDebugMode(), Display,
+			"{Inventory}({Sv}): InventoryTransaction RemoveItem Failed - "
+			"Only {NumRemoved} of {NumRequest} '{ItemName}' were found",
+			Inventory_->GetName(), Inventory_->HasAuthority()?"SRV":"CLI",
+			ItemsRemoved, OrderQuantity, ItemName);
+		bFailed_ = true;
+		return -1;
+	}
+	return ItemsRemoved;
+}
+
+
+int FInventoryTransaction::RemoveFromSlot(int SlotNumber, int OrderQuantity, bool bAllOrNothing)
+{
+	if (!bLocked_ || !Inventory_->IsValidSlotNumber(SlotNumber) || OrderQuantity < 1)
+	{
+		bFailed_ = true;
+		return -1;
+	}
+
+	const int OldQuantity = Inventory_->InventorySlots_[SlotNumber].Quantity;
+	if (OldQuantity < 1 || (bAllOrNothing && OldQuantity < OrderQuantity))
+	{
+		bFailed_ = true;
+		return -1;
+	}
+
+	const int NewQuantity = Inventory_->Helper_SetSlotQuantity(
+		SlotNumber, OldQuantity - FMath::Min(OldQuantity, OrderQuantity));
+	if (NewQuantity < 0)
+	{
+		bFailed_ = true;
+		return -1;
+	}
+	return OldQuantity - NewQuantity;
+}
+
+
+int FInventoryTransaction::SetSlotItem(int SlotNumber, const FItemStatics& ItemStatics, int NewQuantity)
+{
+	const int SlotQuantity = bLocked_ ? Inventory_->Helper_SetSlotItem(SlotNumber, ItemStatics, NewQuantity) : -1;
+	if (SlotQuantity < 0) { bFailed_ = true; }
+	return SlotQuantity;
+}
+
+
+int FInventoryTransaction::SetSlotQuantity(int SlotNumber, int NewQuantity)
+{
+	const int SlotQuantity = bLocked_ ? Inventory_->Helper_SetSlotQuantity(SlotNumber, NewQuantity) : -1;
+	if (SlotQuantity < 0) { bFailed_ = true; }
+	return SlotQuantity;
+}
+
+
+bool FInventoryTransaction::Commit()
+{
+	if (!bLocked_)
+	{
+		return false;
+	}
+	if (bFailed_)
+	{
+		Rollback();
+		return false;
+	}
+
+	for (const int SlotNumber : ChangedSlots_)
+	{
+		Inventory_->Helper_MarkSlotDirty(SlotNumber);
+	}
+	Helper_Unlock();
+
+	// Listeners may read or change the inventory again, so nothing is broadcast under the lock.
+	// The inventory announces the whole transaction once, below, rather than once per slot.
+	for (int i = 0; i < ChangedSlots_.Num(); i++)
+	{
+		Inventory_->Helper_BroadcastSlotChanged(ChangedSlots_[i], OriginalSlots_[i].DataAsset, false);
+	}
+	Inventory_->Helper_CheckWeightThreshold();
+	if (!ChangedSlots_.IsEmpty() && Inventory_->OnTransactionCommitted.IsBound())
+	{
+		Inventory_->OnTransactionCommitted.Broadcast(ChangedSlots_);
+	}
+	return true;
+}
+
+
+void FInventoryTransaction::Rollback()
+{
+	if (!bLocked_) { return; }
+
+	for (int i = ChangedSlots_.Num() - 1; i >= 0; i--)
+	{
+		const int SlotNumber = ChangedSlots_[i];
+		const FInventorySlotData& OriginalSlot = OriginalSlots_[i];
+		FInventorySlotData& InventorySlot = Inventory_->InventorySlots_[SlotNumber];
+
+		const FInventorySlotData PreviousSlot = InventorySlot;
+		InventorySlot.ItemStatics	= OriginalSlot.ItemStatics;
+		InventorySlot.Quantity		= OriginalSlot.Quantity;
+		InventorySlot.DataAsset		= OriginalSlot.DataAsset;
+		InventorySlot.ItemId		= OriginalSlot.ItemId;
+		Inventory_->Helper_UpdateSlotState(SlotNumber, PreviousSlot);
+	}
+	if (!ChangedSlots_.IsEmpty())
+	{
+		INVENTORY_DEBUG_LOG(Inventory_->GetInventoryDebugMode(), Display,
+			"{Inventory}({Sv}): InventoryTransaction Rolled Back {NumSlots} Slots",
+			Inventory_->GetName(), Inventory_->HasAuthority()?"SRV":"CLI", ChangedSlots_.Num());
+	}
+	ChangedSlots_.Reset();
+	OriginalSlots_.Reset();
+	Helper_Unlock();
+}
+
+
+void FInventoryTransaction::Helper_RecordSlotChange(int SlotNumber, const FInventorySlotData& PreviousSlot)
+{
+	if (!ChangedSlots_.Contains(SlotNumber))
+	{
+		ChangedSlots_.Add(SlotNumber);
+		OriginalSlots_.Add(PreviousSlot);
+	}
+}
+
+
+void FInventoryTransaction::Helper_Unlock()
+{
+	Inventory_->ActiveTransaction_ = nullptr;
+	Inventory_->InventoryMutex.WriteUnlock();
+	bLocked_ = false;
+}
@@ -0,0 +1,215 @@
+#include "ItemDefinitionSubsystem.h"
+
+#include "InventoryLog.h"
+#include "Engine/AssetManager.h"
+#include "lib/ItemData.h"
+
+
+FItemDefinitionCache& FItemDefinitionCache::Get()
+{
+	static FItemDefinitionCache Cache;
+	return Cache;
+}
+
+
+const FPrimaryAssetType& FItemDefinitionCache::GetItemAssetType()
+{
+	static const FPrimaryAssetType ItemAssetType(UItemDataAsset::StaticClass()->GetFName());
+	return ItemAssetType;
+}
+
+
+FItemDefinitionCache::FItemDefinitionCache()
+{
+	Definitions_.AddDefaulted();
+}
+
+
+void FItemDefinitionCache::Build()
+{
+	if (!UAssetManager::IsInitialized()) { return; }
+
+	TArray<FPrimaryAssetId> AssetIds;
+	UAssetManager::Get().GetPrimaryAssetIdList(GetItemAssetType(), AssetIds);
+	AssetIds.Sort([](const FPrimaryAssetId& A, const FPrimaryAssetId& B)
+	{
+		return A.PrimaryAssetName.LexicalLess(B.PrimaryAssetName);
+	});
+	for (const FPrimaryAssetId& AssetId : AssetIds)
+	{
+		// Items seen before the scan finished could not read their tags yet
+		const FItemDefinitionId ItemId = FindOrAddItemId(AssetId.PrimaryAssetName);
+		if (ItemId != 0 && !Definitions_[ItemId].bStackSizeKnown)
+		{
+			Helper_ReadRegistryTags(Definitions_[ItemId]);
+		}
+	}
+}
+
+
+FItemDefinitionId FItemDefinitionCache::FindOrAddItemId(const FName& ItemName)
+{
+	if (ItemName.IsNone()) { return 0; }
+	if (const FItemDefinitionId* ItemId = ItemIds_.Find(ItemName))
+	{
+		return *ItemId;
+	}
+	if (Definitions_.Num() > MAX_uint16)
+	{
+		UE_LOGFMT(LogInventory, Error, "ItemDefinitionCache: Out of item ids, '{ItemName}' has none", ItemName);
+		return 0;
+	}
+
+	const FItemDefinitionId NewItemId = static_cast<FItemDefinitionId>(Definitions_.Num());
+	FItemDefinition& Definition = Definitions_.AddDefaulted_GetRef();
+	Definition.ItemName	= ItemName;
+	Definition.AssetId	= FPrimaryAssetId(GetItemAssetType(), ItemName);
+	Helper_ReadRegistryTags(Definition);
+	ItemIds_.Add(ItemName, NewItemId);
+	return NewItemId;
+}
+
+
+void FItemDefinitionCache::Helper_ReadRegistryTags(FItemDefinition& Definition)
+{
+	if (!UAssetManager::IsInitialized()) { return; }
+
+	FAssetData AssetData;
+	if (!UAssetManager::Get().GetPrimaryAssetData(Definition.AssetId, AssetData)) { return; }
+
+	int32 MaxStackSize = 0;
+	if (AssetData.GetTagValue(UPrimaryItemDataAsset::GetMaxStackSizeTagName(), MaxStackSize))
+	{
+		Definition.MaxStackSize		= FMath::Max(MaxStackSize, 1);
+		Definition.bStackSizeKnown	= true;
+	}
+}
+
+
+FItemDefinitionId FItemDefinitionCache::FindItemId(const FName& ItemName) const
+{
+	const FItemDefinitionId* ItemId = ItemIds_.Find(ItemName);
+	return ItemId != nullptr ? *ItemId : 0;
+}
+
+
+void FItemDefinitionCache::RegisterAsset(FItemDefinitionId ItemId, const UItemDataAsset* DataAsset)
+{
+	if (ItemId == 0 || !Definitions_.IsValidIndex(ItemId) || !IsValid(DataAsset)) { return; }
+
+	FItemDefinition& Definition = Definitions_[ItemId];
+	if (Definition.bResolved && Definition.DataAsset.Get() == DataAsset) { return; }
+
+	Definition.DataAsset		= DataAsset;
+	Definition.bResolved		= true;
+	Definition.MaxStackSize		= DataAsset->GetItemMaxStackSize();
+	Definition.bStackSizeKnown	= true;
+	Definition.CarryWeight		= DataAsset->GetItemCarryWeight();
+	Definition.MaxDurability	= DataAsset->GetItemMaxDurability();
+	Definition.bCanActivate		= DataAsset->GetItemCanActivate();
+
+	Definition.CategoryMask = 0;
+	Definition.UnmappedCategories.Reset();
+	for (const FGameplayTag& CategoryTag : DataAsset->GetItemCategories())
+	{
+		const uint32 Bit = Helper_FindOrAddTagBit(CategoryBits_, CategoryTag);
+		if (Bit != 0)	{ Definition.CategoryMask |= Bit; }
+		else			{ Definition.UnmappedCategories.AddTag(CategoryTag); }
+	}
+
+	Definition.EquippableSlotMask = 0;
+	Definition.UnmappedEquippableSlots.Reset();
+	if (const UEquipmentDataAsset* EquipmentAsset = Cast<UEquipmentDataAsset>(DataAsset))
+	{
+		for (const FGameplayTag& SlotTag : EquipmentAsset->EquippableSlots)
+		{
+			const uint32 Bit = Helper_FindOrAddTagBit(EquipmentSlotBits_, SlotTag);
+			if (Bit != 0)	{ Definition.EquippableSlotMask |= Bit; }
+			else			{ Definition.UnmappedEquippableSlots.AddTag(SlotTag); }
+		}
+	}
+}
+
+
+bool FItemDefinition::CanEquipInSlot(const FGameplayTag& SlotTag) const
+{
+	const uint32 Bit = FItemDefinitionCache::Get().GetEquipmentSlotBit(SlotTag);
+	return Bit != 0 ? (EquippableSlotMask & Bit) != 0 : UnmappedEquippableSlots.HasTagExact(SlotTag);
+}
+
+
+bool FItemDefinition::HasCategory(const FGameplayTag& CategoryTag) const
+{
+	const uint32 Bit = FItemDefinitionCache::Get().GetCategoryBit(CategoryTag);
+	return Bit != 0 ? (CategoryMask & Bit) != 0 : UnmappedCategories.HasTagExact(CategoryTag);
+}
+
+
+uint32 FItemDefinitionCache::GetEquipmentSlotBit(const FGameplayTag& SlotTag) const
+{
+	const uint32* Bit = EquipmentSlotBits_.Find(SlotTag);
+	return Bit != nullptr ? *Bit : 0;
+}
+
+
+uint32 FItemDefinitionCache::GetCategoryBit(const FGameplayTag& CategoryTag) const
+{
+	const uint32* Bit = CategoryBits_.Find(CategoryTag);
+	return Bit != nullptr ? *Bit : 0;
+}
+
+
+uint32 FItemDefinitionCache::Helper_FindOrAddTagBit(TMap<FGameplayTag, uint32>& TagBits, const FGameplayTag& Tag)
+{
+	if (const uint32* Bit = TagBits.Find(Tag))
+	{
+		return *Bit;
+	}
+	if (TagBits.Num() >= 32)
+	{
+		// Remembered as zero, so the warning is only logged once per tag
+		UE_LOGFMT(LogInventory, Warning, "ItemDefinitionCache: No tag bits left for '{Tag}', "
+			"it is compared by tag instead", Tag.ToString());
+		TagBits.Add(Tag, 0);
+		return 0;
+	}
+	const uint32 NewBit = 1u << TagBits.Num();
+	TagBits.Add(Tag, NewBit);
+	return NewBit;
+}
+
+
+void UItemDefinitionSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	UAssetManager::CallOrRegister_OnCompletedInitialScan(
+		FSimpleMulticastDelegate::FDelegate::CreateUObject(this, &UItemDefinitionSubsystem::Helper_BuildCache));
+}
+
+
+void UItemDefinitionSubsystem::Helper_BuildCache()
+{
+	FItemDefinitionCache& Cache = FItemDefinitionCache::Get();
+	Cache.Build();
+	UE_LOGFMT(LogInventory, Log, "ItemDefinitionSubsystem: {NumItems} item definitions", Cache.Num());
+}
+
+
+int UItemDefinitionSubsystem::GetItemDefinitionId(FName ItemName) const
+{
+	return FItemDefinitionCache::Get().FindItemId(ItemName);
+}
+
+
+int UItemDefinitionSubsystem::GetNumItemDefinitions() const
+{
+	return FItemDefinitionCache::Get().Num();
+}
+
+
+bool UItemDefinitionSubsystem::GetItemHasCategory(FName ItemName, const FGameplayTag& CategoryTag) const
+{
+	const FItemDefinitionCache& Cache = FItemDefinitionCache::Get();
+	const FItemDefinition* Definition = Cache.Find(Cache.FindItemId(ItemName));
+	return Definition != nullptr && Definition->bResolved && Definition->HasCategory(CategoryTag);
+}
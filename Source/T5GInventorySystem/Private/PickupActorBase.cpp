@@ -2,6 +2,8 @@
 #include "PickupActorBase.h"
 
 #include "InventoryComponent.h"
+#include "InventoryLog.h"
+#include "InventoryStats.h"
 #include "GameFramework/Character.h"
 #include "Net/UnrealNetwork.h"
 
@@ -76,6 +78,7 @@ void APickupActorBase::EndPlay(const EEndPlayReason::Type EndPlayReason)
 void APickupActorBase::CheckOverlapCall(UPrimitiveComponent* OverlappedComp, AActor* OtherActor,
 	UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
+	INVENTORY_SCOPE_CYCLE_COUNTER(STAT_InventoryPickupOverlap);
 	if (HasAuthority())
 	{
 		if (IsValid(OtherActor))
@@ -111,7 +114,7 @@ void APickupActorBase::BeginPlay()
 
 	if (IsValid(ItemDataAsset))
 	{
-		ItemData	 = FStItemData(ItemDataAsset);
+		ItemData	 = FItemStatics(ItemDataAsset);
 		ItemQuantity = StartingQuantity > 0 ? StartingQuantity : 1;
 		SetupItemData();
 	}
@@ -122,13 +125,14 @@ void APickupActorBase::SetupItemData()
 {
 	UStaticMeshComponent* sMesh = GetStaticMeshComponent();
 
-	if (ItemData.GetIsValidItem())
+	if (ItemQuantity > 0)
 	{
-		if (IsValid(ItemData.Data))
+		const UItemDataAsset* ItemAsset = ItemData.GetItemData();
+		if (IsValid(ItemAsset))
 		{
-			if (IsValid( ItemData.Data->GetItemStaticMesh()) )
+			if (IsValid( ItemAsset->GetItemStaticMesh()) )
 			{
-				sMesh->SetStaticMesh( ItemData.Data->GetItemStaticMesh() );
+				sMesh->SetStaticMesh( ItemAsset->GetItemStaticMesh() );
 			}
 		}
 	}
@@ -146,7 +150,7 @@ void APickupActorBase::SetupItemData()
  */
 void APickupActorBase::SetupItem(const FItemStatics& NewItemData, int OrderQuantity)
 {
-	if (!bReady) { return; }
+	// Only before BeginPlay, so spawn the pickup deferred and call this before FinishSpawning
 	if (!HasActorBegunPlay())
 	{
 		ItemData		= NewItemData;
@@ -161,8 +165,9 @@ void APickupActorBase::OnPickedUp(AActor* targetActor)
 	{
 		if (bIsOperating || !bReady)
 		{
-			UE_LOG(LogTemp, Warning, TEXT("%s(%s) is operating and cannot be used right now. Dupe Exploit protection."),
-				*GetName(), (HasAuthority()?TEXT("SERVER"):TEXT("CLIENT")));
+			UE_LOGFMT(LogInventory, Warning,
+				"{Pickup}({Sv}) is operating and cannot be used right now. Dupe Exploit protection.",
+				GetName(), HasAuthority()?"SRV":"CLI");
 			return;
 		}
 		bIsOperating = true;
@@ -171,7 +176,8 @@ void APickupActorBase::OnPickedUp(AActor* targetActor)
 			// Ensure the player isn't unreasonably far from the item
 			if (GetDistanceTo(targetActor) >= 1024)
 			{
-				UE_LOG(LogTemp, Warning, TEXT("%s was too far away to interact with %s"), *targetActor->GetName(), *GetName());
+				UE_LOGFMT(LogInventory, Warning, "{Actor} was too far away to interact with {Pickup}",
+					targetActor->GetName(), GetName());
 				bIsOperating = false;
 				return;
 			}
@@ -179,20 +185,19 @@ void APickupActorBase::OnPickedUp(AActor* targetActor)
 			const ACharacter* playerRef = Cast<ACharacter>(targetActor);
 			if (IsValid(playerRef))
 			{
-				UE_LOG(LogTemp, Display, TEXT("%s(%s): Target Actor is a Character"), *GetName(),
-					(HasAuthority()?TEXT("SRV"):TEXT("CLI")));
+				INVENTORY_DEBUG_LOG(bShowDebug, Display, "{Pickup}({Sv}): Target Actor is a Character",
+					GetName(), HasAuthority()?"SRV":"CLI");
 				UInventoryComponent* invComp = targetActor->FindComponentByClass<UInventoryComponent>();
 				if (IsValid(invComp))
 				{
 					if (!invComp->GetCanPickUpItems()) { return; }
 
-					UE_LOG(LogTemp, Display, TEXT("%s(%s): Adding Item x%d of '%s'"), *GetName(),
-					       (HasAuthority()?TEXT("SRV"):TEXT("CLI")), ItemQuantity, *ItemData.ToString());
+					INVENTORY_DEBUG_LOG(bShowDebug, Display, "{Pickup}({Sv}): Adding Item x{Quantity} of '{ItemName}'",
+						GetName(), HasAuthority()?"SRV":"CLI", ItemQuantity, ItemData.ItemName);
 
 					
-					FStInventorySlot PsuedoSlot = FStInventorySlot(ItemData);
 					const int itemsAdded = invComp->AddItem(
-						PsuedoSlot, ItemQuantity, -1, true, true);
+						ItemData, ItemQuantity, -1, true, true);
 					
 					if (itemsAdded > 0)
 					{
@@ -200,28 +205,30 @@ void APickupActorBase::OnPickedUp(AActor* targetActor)
 						if (ItemQuantity < 1)
 						{
 							// Destroy self. All items added.
-							UE_LOG(LogTemp, Display, TEXT("%s(%s): All items collected. Deleting pickup actor."),
-								*GetName(), HasAuthority()?TEXT("SRV"):TEXT("CLI"));
+							INVENTORY_DEBUG_LOG(bShowDebug, Display,
+								"{Pickup}({Sv}): All items collected. Deleting pickup actor.",
+								GetName(), HasAuthority()?"SRV":"CLI");
 							//K2_DestroyActor();
 							Destroy(true);
 						}
 						else
 						{
 							// Unable to add all of them. Update the quantity remaining.
-							UE_LOG(LogTemp, Display, TEXT("%s(%s): %d still remaining. Pickup actor adjusted."),
-								*GetName(), HasAuthority()?TEXT("SRV"):TEXT("CLI"), ItemQuantity);
+							INVENTORY_DEBUG_LOG(bShowDebug, Display,
+								"{Pickup}({Sv}): {Quantity} still remaining. Pickup actor adjusted.",
+								GetName(), HasAuthority()?"SRV":"CLI", ItemQuantity);
 						}
 					}
 					else
 					{
-						UE_LOG(LogTemp, Warning, TEXT("%s(%s): Failed to add items"),
-							*GetName(), HasAuthority()?TEXT("SRV"):TEXT("CLI"));
+						UE_LOGFMT(LogInventory, Warning, "{Pickup}({Sv}): Failed to add items",
+							GetName(), HasAuthority()?"SRV":"CLI");
 					}
 				}
 				else
 				{
-					UE_LOG(LogTemp, Display, TEXT("%s(%s): Failed to find a valid inventory"), *GetName(),
-						(HasAuthority()?TEXT("SV"):TEXT("CL")));
+					INVENTORY_DEBUG_LOG(bShowDebug, Display, "{Pickup}({Sv}): Failed to find a valid inventory",
+						GetName(), HasAuthority()?"SRV":"CLI");
 				}
 			}
 		}
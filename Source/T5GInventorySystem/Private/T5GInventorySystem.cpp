@@ -1,6 +1,27 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "T5GInventorySystem.h"
+#include "InventoryLog.h"
+#include "InventoryStats.h"
+
+DEFINE_LOG_CATEGORY(LogInventory);
+
+UE_TRACE_CHANNEL_DEFINE(InventoryChannel);
+
+DEFINE_STAT(STAT_InventoryPushComparesAvoided);
+DEFINE_STAT(STAT_InventoryAddItem);
+DEFINE_STAT(STAT_InventoryRemoveItem);
+DEFINE_STAT(STAT_InventoryTransferItems);
+DEFINE_STAT(STAT_InventorySave);
+DEFINE_STAT(STAT_InventoryLoad);
+DEFINE_STAT(STAT_InventoryStoreWriteWait);
+DEFINE_STAT(STAT_InventorySlotReplicated);
+DEFINE_STAT(STAT_InventoryFuelConsumption);
+DEFINE_STAT(STAT_InventoryCraftingTick);
+DEFINE_STAT(STAT_InventoryPickupOverlap);
+DEFINE_STAT(STAT_InventorySlotsScanned);
+DEFINE_STAT(STAT_InventoryAssetLoads);
+DEFINE_STAT(STAT_InventoryBytesReplicated);
 
 #define LOCTEXT_NAMESPACE "FT5GInventorySystemModule"
 
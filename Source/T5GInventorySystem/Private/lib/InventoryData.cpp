@@ -1,11 +1,11 @@
 
 #include "lib/InventoryData.h"
+#include "InventoryLog.h"
 #include "lib/ItemData.h"
-#include "Logging/StructuredLog.h"
 
 /**
 * Performs a die roll, returning true if it succeeded
- * @param dieRoll The resulting die roll
+ * @param dieRoll The resulting die roll, or -1 if the roll could not be won
  * @param winChance The final chance to win
  * @param minChance The minimum winning chance
  * @param maxChance The maximum winning chance
@@ -13,6 +13,8 @@
  */
 static bool RollTheDice(double& dieRoll, double& winChance, double minChance, double maxChance)
 {
+	dieRoll = -1.0;
+
 	// winChance is 'maxChance', but after validation
 	winChance = (maxChance >= minChance) ? maxChance : minChance + 0.01;
 	
@@ -30,7 +32,8 @@ static bool RollTheDice(double& dieRoll, double& winChance, double minChance, do
 	
 	// The chance to win is either the random chance, or the win chance, whichever is highest
 	const double numberToBeat = winChance > highestChance ? highestChance : winChance;
-	return FMath::RandRange(0.f, 1.f) <= winChance;
+	dieRoll = FMath::RandRange(0.f, 1.f);
+	return dieRoll <= winChance;
 }
 
 static int DetermineQuantity(int minRolls = 1, int maxRolls = 1)
@@ -43,11 +46,13 @@ static int DetermineQuantity(int minRolls = 1, int maxRolls = 1)
 /**
  * Returns an array of all starting items, after all data has been generated,
  * such as durability, quantity, rarity and spawn chances.
- * @return Array of items to start with, pre-generated.
+ * @param bShowDebug If true, every die roll is logged
+ * @return Array of items to start with, pre-generated. One entry per item, so
+ *		   an item whose quantity rolled higher than one appears multiple times.
  */
-TArray<FStItemData> UInventoryDataAsset::GetStartingItems() const
+TArray<FItemStatics> UInventoryDataAsset::GetStartingItems(bool bShowDebug) const
 {
-	TArray<FStItemData> stStartingItems = {};
+	TArray<FItemStatics> stStartingItems = {};
 	if (StartingItems.Num() > 0)
 	{
 		for (FStartingItem startItem : StartingItems)
@@ -61,20 +66,19 @@ TArray<FStItemData> UInventoryDataAsset::GetStartingItems() const
 
 			for (int i = 0; i < itemQuantity; i++)
 			{
-				double rollResult, winChance;
+				double rollResult = -1.0, winChance = 0.0;
 				const bool winningRoll = RollTheDice(
 						rollResult, winChance,
 						startItem.ChanceMinimum,
 						startItem.ChanceMaximum);
 			
-				UE_LOGFMT(LogTemp, Display, "GetStartingItems(): "
+				INVENTORY_DEBUG_LOG(bShowDebug, Display, "GetStartingItems(): "
 					"Rolled '{DieRoll}', Needed <= {WinChance}", rollResult, winChance);
 			
 				if (winningRoll)
 				{
-					FStItemData NewItem(startItem.ItemReference);
-					NewItem.DurabilityNow = startItem.ItemReference->GetItemMaxDurability();
-					NewItem.bIsEquipped   = startItem.bEquipOnStart;
+					FItemStatics NewItem(startItem.ItemReference);
+					NewItem.bIsEquipped = startItem.bEquipOnStart;
 					stStartingItems.Add(NewItem);
 				}
 			}
@@ -1,21 +1,380 @@
 ﻿
 #include "lib/InventorySave.h"
 
-#include "lib/InventorySlot.h"
+#include "ItemDefinitionSubsystem.h"
+#include "lib/InventorySlotData.h"
+#include "lib/ItemData.h"
+#include "Misc/Compression.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
 
-TArray<FStInventorySlot> UInventorySave::LoadInventorySlots()
+/*
+ * Compact slot layout. All counts, indices and quantities are packed ints (SerializeIntPacked).
+ *
+ *   uint32 Magic, uint16 Version
+ *   NumSlots
+ *   NumStrings, FString[NumStrings]			Item names, crafter names and gameplay tag names
+ *   NumTaggedSlots, { SlotNumber, NumTags, StringRef[NumTags] }
+ *   NumItems, { SlotDelta, Quantity, ItemNameRef, RarityRef, uint8 Flags,
+ *               [float Durability], [CrafterRef], [int64 CraftTicks] }
+ *
+ * A StringRef is the table index plus one, so zero means none. SlotDelta is the distance
+ * from the slot after the previous item. Empty slots without tags are not written at all.
+ */
+
+namespace
+{
+	constexpr uint32 CompactSaveMagic = 0x49473554; // 'T5GI'
+
+	// Guards the allocation when reading a corrupt slot count
+	constexpr uint32 MaxCompactSaveSlots = 65536;
+
+	// Compressed payload header: uint32 Magic, uint8 EInventorySaveCompression, packed UncompressedSize
+	constexpr uint32 CompressedSaveMagic = 0x5A473554; // 'T5GZ'
+	constexpr uint32 MaxUncompressedSize = 64 * 1024 * 1024;
+
+	FName GetCompressionFormat(EInventorySaveCompression Compression)
+	{
+		switch (Compression)
+		{
+		case EInventorySaveCompression::Zlib:	return NAME_Zlib;
+		case EInventorySaveCompression::Oodle:	return NAME_Oodle;
+		case EInventorySaveCompression::LZ4:	return NAME_LZ4;
+		default:								return NAME_None;
+		}
+	}
+
+	enum ECompactItemFlags : uint8
+	{
+		HasDurability	= 1 << 0,
+		HasCrafter		= 1 << 1,
+		HasTimestamp	= 1 << 2,
+		IsEquipped		= 1 << 3,
+	};
+
+	// Builds the string table while the slots are written
+	struct FCompactStringTable
+	{
+		TArray<FString> Strings;
+		TMap<FString, uint32> Indices;
+
+		uint32 Add(const FString& String)
+		{
+			if (String.IsEmpty()) { return 0; }
+			if (const uint32* Index = Indices.Find(String)) { return *Index + 1; }
+			const uint32 Index = Strings.Add(String);
+			Indices.Add(String, Index);
+			return Index + 1;
+		}
+	};
+
+	bool IsCountPlausible(const FArchive& Ar, uint32 Count)
+	{
+		// Every entry takes at least one byte
+		return !Ar.IsError() && Count <= static_cast<uint32>(Ar.TotalSize() - Ar.Tell());
+	}
+}
+
+
+void UInventorySave::SaveInventorySlots(const TArray<FInventorySlotSaveData>& InventorySlots)
+{
+	EncodeInventorySlots(InventorySlots, CompactInventorySlots);
+
+	// The legacy array is now redundant, which completes the migration of older saves
+	SavedInventorySlots.Empty();
+}
+
+
+void UInventorySave::CompressPayload(TArray<uint8>& InOutBytes, EInventorySaveCompression Compression)
 {
-	return InventorySlots_;
+	const FName FormatName = GetCompressionFormat(Compression);
+	if (FormatName.IsNone() || InOutBytes.IsEmpty() || !FCompression::IsFormatValid(FormatName)) { return; }
+
+	int32 CompressedSize = FCompression::CompressMemoryBound(FormatName, InOutBytes.Num());
+	TArray<uint8> Compressed;
+	Compressed.SetNumUninitialized(CompressedSize);
+	if (!FCompression::CompressMemory(FormatName, Compressed.GetData(), CompressedSize,
+		InOutBytes.GetData(), InOutBytes.Num()))
+	{
+		return;
+	}
+
+	TArray<uint8> Payload;
+	FMemoryWriter Writer(Payload);
+	uint32 Magic			= CompressedSaveMagic;
+	uint8 Codec				= static_cast<uint8>(Compression);
+	uint32 UncompressedSize	= InOutBytes.Num();
+	Writer << Magic;
+	Writer << Codec;
+	Writer.SerializeIntPacked(UncompressedSize);
+	Writer.Serialize(Compressed.GetData(), CompressedSize);
+
+	// Tiny inventories can come out bigger than they went in
+	if (Payload.Num() < InOutBytes.Num())
+	{
+		InOutBytes = MoveTemp(Payload);
+	}
 }
 
-void UInventorySave::SaveInventorySlots(TArray<FStInventorySlot> ArrayOfCopiedSlots)
+
+bool UInventorySave::DecompressPayload(TArray<uint8>& InOutBytes)
 {
-	InventorySlots_.Empty( ArrayOfCopiedSlots.Num() );
-	for (int i = 0; i < ArrayOfCopiedSlots.Num(); i++)
+	FMemoryReader Reader(InOutBytes);
+	uint32 Magic = 0;
+	Reader << Magic;
+	if (Reader.IsError() || Magic != CompressedSaveMagic) { return true; }
+
+	uint8 Codec = 0;
+	uint32 UncompressedSize = 0;
+	Reader << Codec;
+	Reader.SerializeIntPacked(UncompressedSize);
+	const FName FormatName = GetCompressionFormat(static_cast<EInventorySaveCompression>(Codec));
+	if (Reader.IsError() || FormatName.IsNone() || UncompressedSize > MaxUncompressedSize) { return false; }
+
+	TArray<uint8> Uncompressed;
+	Uncompressed.SetNumUninitialized(UncompressedSize);
+	const int64 HeaderSize = Reader.Tell();
+	if (!FCompression::UncompressMemory(FormatName, Uncompressed.GetData(), UncompressedSize,
+		InOutBytes.GetData() + HeaderSize, InOutBytes.Num() - HeaderSize))
 	{
-		if (ArrayOfCopiedSlots[i].ContainsValidItem())
-			{ InventorySlots_.Add( ArrayOfCopiedSlots[i] ); }
-		else
-			{ InventorySlots_.Add( FStItemData() ); }
+		return false;
 	}
-}
\ No newline at end of file
+	InOutBytes = MoveTemp(Uncompressed);
+	return true;
+}
+
+
+bool UInventorySave::LoadInventorySlots(TArray<FInventorySlotSaveData>& OutInventorySlots) const
+{
+	if (CompactInventorySlots.IsEmpty())
+	{
+		OutInventorySlots = SavedInventorySlots;
+		return true;
+	}
+	return DecodeInventorySlots(CompactInventorySlots, OutInventorySlots);
+}
+
+
+void UInventorySave::EncodeSlotSnapshot(const TArray<FInventorySlotSnapshot>& Snapshot, TArray<uint8>& OutBytes,
+	EInventorySaveCompression Compression)
+{
+	TArray<FInventorySlotSaveData> InventorySlots;
+	InventorySlots.SetNum(Snapshot.Num());
+	for (int i = 0; i < Snapshot.Num(); i++)
+	{
+		// The slot tags are rebuilt from the packed tag and flags, exactly as the live slot does
+		FInventorySlotData SlotData;
+		SlotData.SlotTag	= Snapshot[i].SlotTag;
+		SlotData.SlotFlags	= Snapshot[i].SlotFlags;
+		InventorySlots[i].Quantity			= Snapshot[i].Quantity;
+		InventorySlots[i].SavedItemStatics	= Snapshot[i].ItemStatics;
+		InventorySlots[i].SavedSlotTags		= SlotData.GetSlotTags();
+	}
+	EncodeInventorySlots(InventorySlots, OutBytes);
+	CompressPayload(OutBytes, Compression);
+}
+
+
+void UInventorySave::EncodeInventorySlots(const TArray<FInventorySlotSaveData>& InventorySlots, TArray<uint8>& OutBytes)
+{
+	FCompactStringTable StringTable;
+	TArray<TArray<uint32>> SlotTagRefs;
+	uint32 NumTaggedSlots = 0;
+	uint32 NumItems = 0;
+
+	SlotTagRefs.SetNum(InventorySlots.Num());
+	for (int i = 0; i < InventorySlots.Num(); i++)
+	{
+		for (const FGameplayTag& SlotTag : InventorySlots[i].SavedSlotTags)
+		{
+			SlotTagRefs[i].Add( StringTable.Add(SlotTag.ToString()) );
+		}
+		NumTaggedSlots += SlotTagRefs[i].IsEmpty() ? 0 : 1;
+		NumItems += InventorySlots[i].Quantity > 0 && !InventorySlots[i].SavedItemStatics.ItemName.IsNone() ? 1 : 0;
+	}
+
+	// Items are written to a separate buffer so the string table can go first
+	TArray<uint8> ItemBytes;
+	FMemoryWriter ItemWriter(ItemBytes);
+	uint32 NextSlot = 0;
+	for (int i = 0; i < InventorySlots.Num(); i++)
+	{
+		const FInventorySlotSaveData& SavedSlot = InventorySlots[i];
+		const FItemStatics& ItemStatics = SavedSlot.SavedItemStatics;
+		if (SavedSlot.Quantity < 1 || ItemStatics.ItemName.IsNone()) { continue; }
+
+		uint32 SlotDelta	= i - NextSlot;
+		uint32 Quantity		= SavedSlot.Quantity;
+		uint32 ItemNameRef	= StringTable.Add(ItemStatics.ItemName.ToString());
+		uint32 RarityRef	= ItemStatics.Rarity.IsValid() ? StringTable.Add(ItemStatics.Rarity.ToString()) : 0;
+		uint32 CrafterRef	= ItemStatics.CrafterName.IsNone() ? 0 : StringTable.Add(ItemStatics.CrafterName.ToString());
+		int64 CraftTicks	= ItemStatics.CraftTimestamp.GetTicks();
+		float Durability	= ItemStatics.Durability;
+
+		uint8 Flags = 0;
+		if (Durability != -1.f)				{ Flags |= HasDurability; }
+		if (CrafterRef != 0)				{ Flags |= HasCrafter; }
+		if (CraftTicks != 0)				{ Flags |= HasTimestamp; }
+		if (ItemStatics.bIsEquipped)		{ Flags |= IsEquipped; }
+
+		ItemWriter.SerializeIntPacked(SlotDelta);
+		ItemWriter.SerializeIntPacked(Quantity);
+		ItemWriter.SerializeIntPacked(ItemNameRef);
+		ItemWriter.SerializeIntPacked(RarityRef);
+		ItemWriter << Flags;
+		if (Flags & HasDurability)	{ ItemWriter << Durability; }
+		if (Flags & HasCrafter)		{ ItemWriter.SerializeIntPacked(CrafterRef); }
+		if (Flags & HasTimestamp)	{ ItemWriter << CraftTicks; }
+		NextSlot = i + 1;
+	}
+
+	OutBytes.Reset();
+	FMemoryWriter Writer(OutBytes);
+
+	uint32 Magic	= CompactSaveMagic;
+	uint16 Version	= static_cast<uint16>(EInventorySaveVersion::Latest);
+	uint32 NumSlots	= InventorySlots.Num();
+	uint32 NumStrings = StringTable.Strings.Num();
+	Writer << Magic;
+	Writer << Version;
+	Writer.SerializeIntPacked(NumSlots);
+	Writer.SerializeIntPacked(NumStrings);
+	for (FString& String : StringTable.Strings)
+	{
+		Writer << String;
+	}
+
+	Writer.SerializeIntPacked(NumTaggedSlots);
+	for (int i = 0; i < SlotTagRefs.Num(); i++)
+	{
+		if (SlotTagRefs[i].IsEmpty()) { continue; }
+		uint32 SlotNumber	= i;
+		uint32 NumTags		= SlotTagRefs[i].Num();
+		Writer.SerializeIntPacked(SlotNumber);
+		Writer.SerializeIntPacked(NumTags);
+		for (uint32& TagRef : SlotTagRefs[i])
+		{
+			Writer.SerializeIntPacked(TagRef);
+		}
+	}
+
+	Writer.SerializeIntPacked(NumItems);
+	Writer.Serialize(ItemBytes.GetData(), ItemBytes.Num());
+}
+
+
+bool UInventorySave::DecodeInventorySlots(const TArray<uint8>& Bytes, TArray<FInventorySlotSaveData>& OutInventorySlots)
+{
+	// Compressed payloads start with their own header instead of the compact one
+	TArray<uint8> Uncompressed;
+	const TArray<uint8>* CompactBytes = &Bytes;
+	if (Bytes.Num() >= sizeof(uint32) && FPlatformMemory::ReadUnaligned<uint32>(Bytes.GetData()) == CompressedSaveMagic)
+	{
+		Uncompressed = Bytes;
+		if (!DecompressPayload(Uncompressed)) { return false; }
+		CompactBytes = &Uncompressed;
+	}
+
+	FMemoryReader Reader(*CompactBytes);
+	uint32 Magic	= 0;
+	uint16 Version	= 0;
+	Reader << Magic;
+	Reader << Version;
+	if (Magic != CompactSaveMagic || Version > static_cast<uint16>(EInventorySaveVersion::Latest))
+	{
+		return false;
+	}
+
+	uint32 NumSlots = 0;
+	uint32 NumStrings = 0;
+	Reader.SerializeIntPacked(NumSlots);
+	Reader.SerializeIntPacked(NumStrings);
+	if (!IsCountPlausible(Reader, NumStrings)) { return false; }
+
+	TArray<FString> Strings;
+	Strings.SetNum(NumStrings);
+	for (FString& String : Strings)
+	{
+		Reader << String;
+	}
+	auto GetString = [&Strings](uint32 StringRef) -> const FString*
+	{
+		return StringRef > 0 && Strings.IsValidIndex(StringRef - 1) ? &Strings[StringRef - 1] : nullptr;
+	};
+	auto GetTag = [&GetString](uint32 StringRef) -> FGameplayTag
+	{
+		const FString* TagName = GetString(StringRef);
+		return TagName ? FGameplayTag::RequestGameplayTag(FName(*TagName), false) : FGameplayTag();
+	};
+
+	if (Reader.IsError() || NumSlots > MaxCompactSaveSlots) { return false; }
+	OutInventorySlots.Reset(NumSlots);
+	OutInventorySlots.SetNum(NumSlots);
+
+	uint32 NumTaggedSlots = 0;
+	Reader.SerializeIntPacked(NumTaggedSlots);
+	if (!IsCountPlausible(Reader, NumTaggedSlots)) { return false; }
+	for (uint32 i = 0; i < NumTaggedSlots; i++)
+	{
+		uint32 SlotNumber	= 0;
+		uint32 NumTags		= 0;
+		Reader.SerializeIntPacked(SlotNumber);
+		Reader.SerializeIntPacked(NumTags);
+		if (SlotNumber >= NumSlots || !IsCountPlausible(Reader, NumTags)) { return false; }
+		for (uint32 t = 0; t < NumTags; t++)
+		{
+			uint32 TagRef = 0;
+			Reader.SerializeIntPacked(TagRef);
+			const FGameplayTag SlotTag = GetTag(TagRef);
+			if (SlotTag.IsValid()) { OutInventorySlots[SlotNumber].SavedSlotTags.AddTag(SlotTag); }
+		}
+	}
+
+	uint32 NumItems = 0;
+	Reader.SerializeIntPacked(NumItems);
+	if (!IsCountPlausible(Reader, NumItems)) { return false; }
+	uint32 NextSlot = 0;
+	for (uint32 i = 0; i < NumItems; i++)
+	{
+		uint32 SlotDelta	= 0;
+		uint32 Quantity		= 0;
+		uint32 ItemNameRef	= 0;
+		uint32 RarityRef	= 0;
+		uint8 Flags			= 0;
+		Reader.SerializeIntPacked(SlotDelta);
+		Reader.SerializeIntPacked(Quantity);
+		Reader.SerializeIntPacked(ItemNameRef);
+		Reader.SerializeIntPacked(RarityRef);
+		Reader << Flags;
+
+		const uint64 SlotNumber = static_cast<uint64>(NextSlot) + SlotDelta;
+		const FString* ItemName = GetString(ItemNameRef);
+		if (Reader.IsError() || SlotNumber >= NumSlots || ItemName == nullptr) { return false; }
+
+		FInventorySlotSaveData& SavedSlot = OutInventorySlots[SlotNumber];
+		FItemStatics& ItemStatics = SavedSlot.SavedItemStatics;
+		SavedSlot.Quantity		= static_cast<int>(FMath::Min<uint32>(Quantity, MAX_int32));
+		ItemStatics.ItemName	= FName(**ItemName);
+		ItemStatics.Rarity		= RarityRef != 0 ? GetTag(RarityRef) : FGameplayTag();
+		ItemStatics.bIsEquipped	= (Flags & IsEquipped) != 0;
+		if (Flags & HasDurability)
+		{
+			Reader << ItemStatics.Durability;
+		}
+		if (Flags & HasCrafter)
+		{
+			uint32 CrafterRef = 0;
+			Reader.SerializeIntPacked(CrafterRef);
+			if (const FString* CrafterName = GetString(CrafterRef)) { ItemStatics.CrafterName = FName(**CrafterName); }
+		}
+		if (Flags & HasTimestamp)
+		{
+			int64 CraftTicks = 0;
+			Reader << CraftTicks;
+			ItemStatics.CraftTimestamp = FDateTime(CraftTicks);
+		}
+		SavedSlot.SavedAssetId = FPrimaryAssetId(FItemDefinitionCache::GetItemAssetType(), ItemStatics.ItemName);
+		NextSlot = SlotNumber + 1;
+	}
+	return !Reader.IsError();
+}
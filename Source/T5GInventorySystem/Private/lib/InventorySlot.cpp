@@ -1,30 +1,9 @@
 ﻿#include "lib/InventorySlot.h"
 
 #include "InventoryComponent.h"
-#include "Abilities/GameplayAbility.h"
-#include "Engine/AssetManager.h"
-#include "Engine/StreamableManager.h"
+#include "InventoryLog.h"
 #include "lib/InventorySave.h"
 #include "lib/ItemData.h"
-#include "Logging/StructuredLog.h"
-
-
-void UInventorySlot::OnRep_QuantityUpdated_Implementation(int OldQuantity)
-{
-	if (OnSlotUpdated.IsBound())
-	{
-		OnSlotUpdated.Broadcast(SlotNumber_);
-	}
-}
-
-
-void UInventorySlot::OnRep_ItemUpdated_Implementation(const FItemStatics& ItemPreChanges)
-{
-	if (OnSlotUpdated.IsBound())
-	{
-		OnSlotUpdated.Broadcast(SlotNumber_);
-	}
-}
 
 
 bool UInventorySlot::HasAuthority() const
@@ -35,36 +14,33 @@ bool UInventorySlot::HasAuthority() const
 }
 
 
-bool UInventorySlot::TryLoadAsset(const FPrimaryAssetId& AssetId)
+bool UInventorySlot::IsBoundToInventory() const
 {
-	UAssetManager&        AssetManager = UAssetManager::Get();
-	const UItemDataAsset* tempAsset    = Cast<UItemDataAsset>(AssetManager.GetPrimaryAssetObject(AssetId));
+	return IsValid(ParentInventory_) && ParentInventory_->IsValidSlotNumber(SlotNumber_);
+}
+
 
-	// The asset is already loaded
-	if (IsValid(tempAsset)) { return true; }
-	
-	// If the AssetID is valid, and the object is not, load the asset
-	if (AssetId.IsValid())
+const FInventorySlotData& UInventorySlot::GetSlotData() const
+{
+	if (IsBoundToInventory())
 	{
-		const TArray<FName> AssetBundle = {};
-		const FStreamableDelegate StreamDelegate = FStreamableDelegate::CreateUObject(
-			this, &UInventorySlot::AssetLoadedDelegate);
-		AssetManager.LoadPrimaryAsset(AssetId, AssetBundle, StreamDelegate);
-		return true;
+		return ParentInventory_->GetSlotData(SlotNumber_);
 	}
-	return false;
+	return LocalData_;
 }
 
 /**
- * Attempts to create an inventory slot, modeled after the save data 
+ * Attempts to create an inventory slot, modeled after the save data.
+ * Only affects unbound slots. Bound slots are restored by the parent inventory.
  * @param SaveData The save data to restore the slot from
  */
 void UInventorySlot::RestoreInventorySlot(const FInventorySlotSaveData& SaveData)
 {
-	Quantity_    = SaveData.Quantity;
-	ItemStatics_ = SaveData.SavedItemStatics;
-	AssetId_     = SaveData.SavedAssetId;
-	SlotTags_	 = SaveData.SavedSlotTags;
+	if (IsBoundToInventory()) { return; }
+	LocalData_.Quantity    = SaveData.Quantity;
+	LocalData_.ItemStatics = SaveData.SavedItemStatics;
+	LocalData_.SetSlotTags(SaveData.SavedSlotTags);
+	LocalData_.ResolveDataAsset();
 }
 
 
@@ -79,23 +55,28 @@ void UInventorySlot::AddInventorySlotTags(const FGameplayTagContainer& NewTags)
 
 void UInventorySlot::AddInventorySlotTag(const FGameplayTag& NewTag)
 {
+	// Slot configuration of bound slots is owned by the parent inventory
+	if (IsBoundToInventory()) { return; }
 	if (NewTag.MatchesTag(TAG_Inventory) || NewTag.MatchesTag(TAG_Equipment))
 	{
-		SlotTags_.AddTag(NewTag);
+		FGameplayTagContainer SlotTags = LocalData_.GetSlotTags();
+		SlotTags.AddTag(NewTag);
+		LocalData_.SetSlotTags(SlotTags);
 	}
 }
 
 
-void UInventorySlot::InitializeSlot(const UInventoryComponent* ParentInventory, int SlotNumber)
+void UInventorySlot::InitializeSlot(UInventoryComponent* ParentInventory, int SlotNumber)
 {
 	ParentInventory_ = ParentInventory;
 	SlotNumber_      = SlotNumber;
+	LocalData_.SlotNumber = SlotNumber;
 }
 
 
 const UEquipmentDataAsset* UInventorySlot::GetItemDataAsEquipment() const
 {
-	return Cast<UEquipmentDataAsset>(DataAsset_);
+	return GetSlotData().GetItemDataAsEquipment();
 }
 
 /**
@@ -103,24 +84,27 @@ const UEquipmentDataAsset* UInventorySlot::GetItemDataAsEquipment() const
  * @param OrderQuantity The new quantity. Values <= zero will clear the slot.
  * @return True on success, false otherwise
  */
-bool                       UInventorySlot::SetQuantity(int OrderQuantity)
+bool UInventorySlot::SetQuantity(int OrderQuantity)
 {
-	if (!ContainsValidItem())
+	if (IsBoundToInventory())
+	{
+		return ParentInventory_->SetSlotQuantity(SlotNumber_, OrderQuantity) >= 0;
+	}
+
+	if (LocalData_.IsEmpty())
 	{
 		return false;
 	}
 
-	const int NewQuantity = GetQuantity() + (OrderQuantity > 0 ? OrderQuantity : 0);
-	if (NewQuantity < 1)
+	if (OrderQuantity < 1)
 	{
-		ResetAndEmptySlot();
+		LocalData_.ResetItem();
 		return true;
 	}
 
-	const int QuantityMax = DataAsset_->GetItemMaxStackSize();
-	Quantity_             = NewQuantity > QuantityMax ? QuantityMax : NewQuantity;
-
-	return (Quantity_ == NewQuantity || Quantity_ == QuantityMax);
+	const int QuantityMax = LocalData_.ContainsValidItem() ? LocalData_.GetMaxStackAllowance() : OrderQuantity;
+	LocalData_.Quantity   = OrderQuantity > QuantityMax ? QuantityMax : OrderQuantity;
+	return true;
 }
 
 
@@ -128,14 +112,19 @@ bool                       UInventorySlot::SetQuantity(int OrderQuantity)
  * Performs an absolute value of the quantity, decreasing
  * the quantity of the item in the slot.
  * @param OrderQuantity The amount to decrease by
- * @return The new quantity of the item in this slot. Negative indicates failure.
+ * @return The number of items actually removed. Negative indicates failure.
  */
 int UInventorySlot::DecreaseQuantity(int OrderQuantity)
 {
 	const int AdjustQuantity = abs(OrderQuantity);
-	if (SetQuantity(GetQuantity() - AdjustQuantity))
+	if (IsBoundToInventory())
+	{
+		return ParentInventory_->DecreaseSlotQuantity(SlotNumber_, AdjustQuantity);
+	}
+	const int StartQuantity = GetQuantity();
+	if (SetQuantity(StartQuantity - AdjustQuantity))
 	{
-		return GetQuantity();
+		return StartQuantity - GetQuantity();
 	}
 	return -1;
 }
@@ -145,14 +134,19 @@ int UInventorySlot::DecreaseQuantity(int OrderQuantity)
  * Performs an absolute value of the quantity, increasing
  * the quantity of the item in the slot.
  * @param OrderQuantity The amount to increase by
- * @return The new quantity of the item in this slot. Negative indicates failure.
+ * @return The number of items actually added. Negative indicates failure.
  */
 int UInventorySlot::IncreaseQuantity(int OrderQuantity)
 {
 	const int AdjustQuantity = abs(OrderQuantity);
-	if (SetQuantity(GetQuantity() + AdjustQuantity))
+	if (IsBoundToInventory())
+	{
+		return ParentInventory_->IncreaseSlotQuantity(SlotNumber_, AdjustQuantity);
+	}
+	const int StartQuantity = GetQuantity();
+	if (SetQuantity(StartQuantity + AdjustQuantity))
 	{
-		return GetQuantity();
+		return GetQuantity() - StartQuantity;
 	}
 	return -1;
 }
@@ -160,11 +154,7 @@ int UInventorySlot::IncreaseQuantity(int OrderQuantity)
 
 bool UInventorySlot::GetIsEquipmentSlot() const
 {
-	if (!SlotTags_.HasTag(TAG_Inventory_Slot_Equipment))
-	{
-		return SlotTags_.HasTag(TAG_Equipment_Slot);
-	}
-	return true;
+	return GetSlotData().GetIsEquipmentSlot();
 }
 
 
@@ -174,12 +164,16 @@ bool UInventorySlot::SetDurability(float DurabilityValue)
 	{
 		return false;
 	}
-	if (ContainsValidItem())
+	if (IsBoundToInventory())
+	{
+		return ParentInventory_->SetSlotDurability(SlotNumber_, DurabilityValue);
+	}
+	if (LocalData_.ContainsValidItem())
 	{
 		// Item is vulnerable/fragile
-		if (DataAsset_->GetItemMaxDurability() > 0.f)
+		if (LocalData_.GetItemMaxDurability() > 0.f)
 		{
-			ItemStatics_.Durability = DurabilityValue;
+			LocalData_.ItemStatics.Durability = DurabilityValue;
 			return true;
 		}
 	}
@@ -211,13 +205,13 @@ float UInventorySlot::RepairDurability(float RepairAmount)
 
 float UInventorySlot::GetDurability() const
 {
-	return ContainsValidItem() ? ItemStatics_.Durability : -1.f;
+	return ContainsValidItem() ? GetItemStatics().Durability : -1.f;
 }
 
 
 int UInventorySlot::GetMaxStackAllowance() const
 {
-	return ContainsValidItem() ? DataAsset_->GetItemMaxStackSize() : 0;
+	return GetSlotData().GetMaxStackAllowance();
 }
 
 
@@ -230,20 +224,20 @@ void UInventorySlot::ActivateSlot()
 {
 	if (!ContainsValidItem())
 	{
-		UE_LOGFMT(LogTemp, Display, "{iSlot}({nSlot}): Activation Failed - This slot does not contain any items.",
+		INVENTORY_DEBUG_LOG(IsValid(ParentInventory_) && ParentInventory_->GetInventoryDebugMode(), Display, "{iSlot}({nSlot}): Activation Failed - This slot does not contain any items.",
 				  GetNameSafe(this), SlotNumber_);
 		return;
 	}
 
-	if (!DataAsset_->GetItemCanActivate())
+	if (!GetSlotData().GetItemCanActivate())
 	{
-		UE_LOGFMT(LogTemp, Display, "{iSlot}({nSlot}): The item ({ItemName}) in this slot does not activate.",
-				  GetNameSafe(this), SlotNumber_, ItemStatics_.ItemName);
+		INVENTORY_DEBUG_LOG(IsValid(ParentInventory_) && ParentInventory_->GetInventoryDebugMode(), Display, "{iSlot}({nSlot}): The item ({ItemName}) in this slot does not activate.",
+				  GetNameSafe(this), SlotNumber_, GetItemName());
 		return;
 	}
 
-	UE_LOGFMT(LogTemp, Display, "{iSlot}({nSlot}): Activating Item '{ItemName}'", GetNameSafe(this), SlotNumber_,
-			  ItemStatics_.ItemName);
+	INVENTORY_DEBUG_LOG(IsValid(ParentInventory_) && ParentInventory_->GetInventoryDebugMode(), Display, "{iSlot}({nSlot}): Activating Item '{ItemName}'", GetNameSafe(this), SlotNumber_,
+			  GetItemName());
 
 	// Notify listeners
 	OnSlotActivated.Broadcast(SlotNumber_, GetItemData());
@@ -256,17 +250,21 @@ void UInventorySlot::ActivateSlot()
  * Method is NOT a reliable way to check if the slot is empty.
  * @param DataAsset The data asset to check for.
  * @param ItemStatics (opt) If valid, checks that the item is an exact match
- * @return 
+ * @return
  */
 bool UInventorySlot::ContainsItem(const UItemDataAsset* DataAsset, const FItemStatics& ItemStatics) const
 {
 	if (IsValid(DataAsset) && ContainsValidItem())
 	{
+		if (GetItemData() != DataAsset)
+		{
+			return false;
+		}
 		if (ItemStatics.ItemName.IsNone())
 		{
 			return true;
 		}
-		return (ItemStatics_ == ItemStatics);
+		return (GetItemStatics() == ItemStatics);
 	}
 	return false;
 }
@@ -278,37 +276,22 @@ bool UInventorySlot::ContainsItem(const UItemDataAsset* DataAsset, const FItemSt
  * Method is NOT a reliable way to check if the slot is empty.
  * @param ItemName The item name to check for.
  * @param ItemStatics (opt) If valid, checks that the item is an exact match
- * @return 
+ * @return
  */
 bool UInventorySlot::ContainsItem(const FName& ItemName, const FItemStatics& ItemStatics) const
 {
-	const FPrimaryAssetType itemType = UItemDataAsset::StaticClass()->GetFName();
-	const FPrimaryAssetId   newAssetId(itemType, ItemName);
-	if (!ItemStatics_.ItemName.IsNone())
-	{
-		if (newAssetId == AssetId_)
-		{
-			return ItemStatics == ItemStatics_;
-		}
-	}
-	return (newAssetId == AssetId_);
+	return GetSlotData().ContainsItem(ItemName, ItemStatics);
 }
 
 
 float UInventorySlot::GetCarryWeight() const
 {
-	if (ContainsValidItem())
-	{
-		return GetQuantity() * DataAsset_->GetItemCarryWeight();
-	}
-	return ITEM_WEIGHT_EMPTY;
+	return GetSlotData().GetCarryWeight();
 }
 
 
 /**
- * Adds a brand new item by the FName given, if the slot is empty or
- * if the slot contains the same item with the same generated statics.
- * Generates a result from all possible outcomes of the item.
+ * Adds a brand new item by the FName given, if the slot is empty.
  * To control exactly what is created, either copy an item using
  * 'CopyItemFromSlot', or use the overload function 'AddItem(FItemStatics, int)'
  * @param ItemName The Name of the DataAsset for the item to be added
@@ -317,22 +300,10 @@ float UInventorySlot::GetCarryWeight() const
  */
 int UInventorySlot::AddItem(const FName& ItemName, int NewQuantity)
 {
-	const FPrimaryAssetType itemType = UItemDataAsset::StaticClass()->GetFName();
-	const FName             itemName = ItemName;
-	const FPrimaryAssetId   newAssetId(itemType, itemName);
-
-	if (newAssetId.IsValid())
-	{
-		// if server, load the asset and make sure the item can be added
-		if (HasAuthority())
-		{
-			if (!TryLoadAsset(newAssetId)) { return 0; }
-		}
-		
-		AssetId_  = newAssetId;
-		Quantity_ = NewQuantity;
-	}
-	return -1;
+	if (ItemName.IsNone()) { return 0; }
+	FItemStatics NewItemStatics;
+	NewItemStatics.ItemName = ItemName;
+	return AddItem(NewItemStatics, NewQuantity);
 }
 
 
@@ -346,59 +317,43 @@ int UInventorySlot::AddItem(const FName& ItemName, int NewQuantity)
  */
 int UInventorySlot::AddItem(const FItemStatics& ItemStatics, int NewQuantity)
 {
-	const FPrimaryAssetType itemType = UItemDataAsset::StaticClass()->GetFName();
-	const FName             itemName = ItemStatics.ItemName;
-	const FPrimaryAssetId   newAssetId(itemType, itemName);
+	if (ItemStatics.ItemName.IsNone()) { return 0; }
 
-	if (newAssetId.IsValid())
+	// Same exact item, so stack the items
+	if (!IsEmpty())
 	{
-		// Checks if the slot already contains an item
-		if (ContainsValidItem())
+		if (ContainsItem(ItemStatics.ItemName, ItemStatics))
 		{
-			if (ContainsItem(ItemStatics.ItemName, ItemStatics))
-			{
-				// Stack the items
-			}
-			return 0;
+			return IncreaseQuantity(NewQuantity);
 		}
-		
-		// Set the item data values
-		ItemStatics_ = FItemStatics(ItemStatics);
-		Quantity_    = NewQuantity;
+		return 0;
+	}
 
-		// Load the data asset
-		AssetId_ = newAssetId;
+	const int StartQuantity = GetQuantity();
+	if (SetItem(ItemStatics, NewQuantity))
+	{
+		return GetQuantity() - StartQuantity;
 	}
-	return -1;
+	return 0;
 }
 
 
 bool UInventorySlot::SetItem(const FItemStatics& ItemStatics, int NewQuantity)
 {
-	const FPrimaryAssetType itemType = UItemDataAsset::StaticClass()->GetFName();
-	const FName             itemName = ItemStatics.ItemName;
-	const FPrimaryAssetId   newAssetId(itemType, itemName);
-	if (newAssetId.IsValid())
+	if (ItemStatics.ItemName.IsNone())
 	{
-		// Checks if the slot already contains an item
-		if (ContainsValidItem())
-		{
-			if (ContainsItem(ItemStatics.ItemName, ItemStatics))
-			{
-				// Stack the items
-			}
-			return false;
-		}
-		
-		// Set the item data values
-		ItemStatics_ = FItemStatics(ItemStatics);
-		Quantity_    = NewQuantity;
-
-		// Load the data asset
-		AssetId_ = newAssetId;
-		return true;
+		return false;
 	}
-	return false;
+	if (IsBoundToInventory())
+	{
+		return ParentInventory_->SetSlotItem(SlotNumber_, ItemStatics, NewQuantity) >= 0;
+	}
+
+	// Set the item data values and load the data asset
+	LocalData_.ItemStatics = ItemStatics;
+	LocalData_.Quantity    = NewQuantity;
+	LocalData_.ResolveDataAsset();
+	return true;
 }
 
 
@@ -426,108 +381,59 @@ void UInventorySlot::CopyItemFromSlot(const UInventorySlot* SlotReference, int N
 
 bool UInventorySlot::ContainsValidItem() const
 {
-	return IsValid(DataAsset_) && Quantity_ > 0;
+	return GetSlotData().ContainsValidItem();
 }
 
 
 /**
- * Unbinds all listeners, destroys references, empties the slot,
- * and attempts to unload the asset through asset manager
+ * Empties the slot, leaving the slot configuration untouched
  */
 void UInventorySlot::ResetAndEmptySlot()
 {
-	// Reset Relevant Data
-	Quantity_ = 0;
-
-	// Resets the item data & asset reference on replication
-	AssetId_ = FPrimaryAssetId();
+	if (IsBoundToInventory())
+	{
+		ParentInventory_->SetSlotQuantity(SlotNumber_, 0);
+		return;
+	}
+	LocalData_.ResetItem();
 }
 
 
 bool UInventorySlot::IsEmpty() const
 {
-	return !IsValid(DataAsset_) || Quantity_ < 1;
+	return GetSlotData().IsEmpty();
 }
 
 
 bool UInventorySlot::IsFull() const
 {
-	if (ContainsValidItem())
-	{
-		return GetQuantity() >= GetMaxStackAllowance();
-	}
-	return false;
+	return GetSlotData().IsFull();
 }
 
 
 bool UInventorySlot::ContainsTag(const FGameplayTag& SearchTag) const
 {
-	return SlotTags_.HasTag(SearchTag);
+	return GetSlotData().ContainsTag(SearchTag);
 }
 
 
 bool UInventorySlot::ContainsTag(const FGameplayTagContainer& SearchTags) const
 {
-	for (auto SearchTag : SearchTags)
-	{
-		if (SlotTags_.HasTag(SearchTag))
-		{
-			return true;
-		}
-	}
-	return false;
-}
-
-
-void UInventorySlot::AssetLoadedDelegate()
-{
-	const UAssetManager& AssetManager = UAssetManager::Get();
-	DataAsset_                        = Cast<UItemDataAsset>(AssetManager.GetPrimaryAssetObject(AssetId_));
-
-	// Validate the pre-load data
-	if (IsValid(DataAsset_))
-	{
-		int maxStack = DataAsset_->GetItemMaxStackSize();
-		if (GetQuantity() > maxStack) { SetQuantity(maxStack); }
-	}
-	
+	return GetSlotData().ContainsTag(SearchTags);
 }
 
 
-void UInventorySlot::OnRep_AssetId_Implementation()
+void UInventorySlot::BroadcastSlotChanged(const UItemDataAsset* PreviousItem)
 {
-	UAssetManager&        AssetManager = UAssetManager::Get();
-	const UItemDataAsset* tempAsset    = Cast<UItemDataAsset>(AssetManager.GetPrimaryAssetObject(AssetId_));
-
-	// The asset is already loaded
-	if (IsValid(tempAsset))
-	{
-		DataAsset_ = tempAsset;
-	}
-
-	else
+	if (PreviousItem != GetItemData())
 	{
-		// If the AssetID is valid, and the object is not, load the asset
-		if (AssetId_.IsValid())
+		if (OnSlotItemChanged.IsBound())
 		{
-			const TArray<FName>       AssetBundle    = {};
-			const FStreamableDelegate StreamDelegate = FStreamableDelegate::CreateUObject(
-				this, &UInventorySlot::AssetLoadedDelegate);
-			AssetManager.LoadPrimaryAsset(AssetId_, AssetBundle, StreamDelegate);
-		}
-		// If the assetID is not valid, this is an empty slot
-		else
-		{
-			const UItemDataAsset* ItemReference = DataAsset_;
-			ItemStatics_                        = FItemStatics();
-			DataAsset_                          = nullptr;
-			if (IsValid(ItemReference))
-			{
-				if (OnSlotItemChanged.IsBound())
-				{
-					OnSlotItemChanged.Broadcast(SlotNumber_, ItemReference);
-				}
-			}
+			OnSlotItemChanged.Broadcast(SlotNumber_, PreviousItem);
 		}
 	}
+	if (OnSlotUpdated.IsBound())
+	{
+		OnSlotUpdated.Broadcast(SlotNumber_);
+	}
 }
@@ -0,0 +1,245 @@
+#include "lib/InventorySlotData.h"
+
+#include "InventoryComponent.h"
+#include "InventoryStats.h"
+#include "Engine/PackageMapClient.h"
+#include "lib/ItemData.h"
+
+
+FPrimaryAssetId FInventorySlotData::GetPrimaryAssetId() const
+{
+	if (ItemStatics.ItemName.IsNone()) { return FPrimaryAssetId(); }
+	return FPrimaryAssetId(FItemDefinitionCache::GetItemAssetType(), ItemStatics.ItemName);
+}
+
+
+const UEquipmentDataAsset* FInventorySlotData::GetItemDataAsEquipment() const
+{
+	return Cast<UEquipmentDataAsset>(DataAsset);
+}
+
+
+/**
+ * Checks if this slot contains the item given. If InItemStatics is given, the check makes sure
+ * that the item in this slot is the exact same item, including durability, rarity and crafter.
+ * @param ItemName The item name to check for.
+ * @param InItemStatics (opt) If it has a valid ItemName, checks that the item is an exact match
+ * @return True if the item was found in this slot
+ */
+bool FInventorySlotData::ContainsItem(const FName& ItemName, const FItemStatics& InItemStatics) const
+{
+	if (IsEmpty() || ItemStatics.ItemName != ItemName)
+	{
+		return false;
+	}
+	if (InItemStatics.ItemName.IsNone())
+	{
+		return true;
+	}
+	return ItemStatics == InItemStatics;
+}
+
+
+const FItemDefinition* FInventorySlotData::GetItemDefinition() const
+{
+	if (IsEmpty() || DataAsset == nullptr) { return nullptr; }
+	const FItemDefinition* Definition = FItemDefinitionCache::Get().Find(ItemId);
+	return (Definition != nullptr && Definition->bResolved) ? Definition : nullptr;
+}
+
+
+bool FInventorySlotData::ContainsTag(const FGameplayTag& SearchTag) const
+{
+	if (SearchTag.MatchesTagExact(TAG_Inventory_Slot_Equipment))
+	{
+		return HasFlag(EInventorySlotFlags::Equipment);
+	}
+	if (SearchTag.MatchesTagExact(TAG_Inventory_Slot_Locked))
+	{
+		return HasFlag(EInventorySlotFlags::Locked);
+	}
+	if (SearchTag.MatchesTagExact(TAG_Inventory_Slot_Mirrored))
+	{
+		return HasFlag(EInventorySlotFlags::Mirrored);
+	}
+	if (SearchTag.MatchesTagExact(TAG_Inventory_Slot_Hidden))
+	{
+		return HasFlag(EInventorySlotFlags::Hidden);
+	}
+	return SlotTag.MatchesTag(SearchTag);
+}
+
+
+bool FInventorySlotData::ContainsTag(const FGameplayTagContainer& SearchTags) const
+{
+	for (const FGameplayTag& SearchTag : SearchTags)
+	{
+		if (ContainsTag(SearchTag))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+
+int FInventorySlotData::GetMaxStackAllowance() const
+{
+	const FItemDefinition* Definition = GetItemDefinition();
+	return Definition != nullptr ? Definition->MaxStackSize : 0;
+}
+
+
+bool FInventorySlotData::IsFull() const
+{
+	const FItemDefinition* Definition = GetItemDefinition();
+	return Definition != nullptr && Quantity >= Definition->MaxStackSize;
+}
+
+
+float FInventorySlotData::GetCarryWeight() const
+{
+	const FItemDefinition* Definition = GetItemDefinition();
+	return Definition != nullptr ? Quantity * Definition->CarryWeight : ITEM_WEIGHT_EMPTY;
+}
+
+
+float FInventorySlotData::GetItemMaxDurability() const
+{
+	const FItemDefinition* Definition = GetItemDefinition();
+	return Definition != nullptr ? Definition->MaxDurability : 0.f;
+}
+
+
+bool FInventorySlotData::GetItemCanActivate() const
+{
+	const FItemDefinition* Definition = GetItemDefinition();
+	return Definition != nullptr && Definition->bCanActivate;
+}
+
+
+bool FInventorySlotData::CanEquipItem(const FItemDefinition* Definition) const
+{
+	if (Definition == nullptr || !SlotTag.IsValid()) { return false; }
+	return Definition->CanEquipInSlot(SlotTag);
+}
+
+
+bool FInventorySlotData::ResolveDataAsset()
+{
+	if (ItemStatics.ItemName.IsNone())
+	{
+		DataAsset	= nullptr;
+		ItemId		= 0;
+		return true;
+	}
+
+	// The cache remembers resident assets, so only the first slot of an item asks the asset manager
+	ItemId		= FItemDefinitionCache::Get().FindOrAddItemId(ItemStatics.ItemName);
+	DataAsset	= ItemStatics.GetItemData();
+	return IsValid(DataAsset);
+}
+
+
+void FInventorySlotData::SetDataAsset(const UItemDataAsset* NewDataAsset)
+{
+	FItemDefinitionCache& Cache = FItemDefinitionCache::Get();
+	DataAsset	= NewDataAsset;
+	ItemId		= Cache.FindOrAddItemId(ItemStatics.ItemName);
+	if (IsValid(NewDataAsset) && NewDataAsset->GetPrimaryAssetId().PrimaryAssetName == ItemStatics.ItemName)
+	{
+		Cache.RegisterAsset(ItemId, NewDataAsset);
+	}
+}
+
+
+FGameplayTagContainer FInventorySlotData::GetSlotTags() const
+{
+	FGameplayTagContainer SlotTags;
+	if (SlotTag.IsValid())							{ SlotTags.AddTag(SlotTag); }
+	if (HasFlag(EInventorySlotFlags::Equipment))	{ SlotTags.AddTag(TAG_Inventory_Slot_Equipment); }
+	if (HasFlag(EInventorySlotFlags::Locked))		{ SlotTags.AddTag(TAG_Inventory_Slot_Locked); }
+	if (HasFlag(EInventorySlotFlags::Mirrored))		{ SlotTags.AddTag(TAG_Inventory_Slot_Mirrored); }
+	if (HasFlag(EInventorySlotFlags::Hidden))		{ SlotTags.AddTag(TAG_Inventory_Slot_Hidden); }
+	return SlotTags;
+}
+
+
+void FInventorySlotData::SetSlotTags(const FGameplayTagContainer& NewTags)
+{
+	SlotTag		= FGameplayTag::EmptyTag;
+	SlotFlags	= 0;
+	for (const FGameplayTag& NewTag : NewTags)
+	{
+		if		(NewTag.MatchesTagExact(TAG_Inventory_Slot_Equipment))	{ SetFlag(EInventorySlotFlags::Equipment); }
+		else if (NewTag.MatchesTagExact(TAG_Inventory_Slot_Locked))		{ SetFlag(EInventorySlotFlags::Locked); }
+		else if (NewTag.MatchesTagExact(TAG_Inventory_Slot_Mirrored))	{ SetFlag(EInventorySlotFlags::Mirrored); }
+		else if (NewTag.MatchesTagExact(TAG_Inventory_Slot_Hidden))		{ SetFlag(EInventorySlotFlags::Hidden); }
+		else if (NewTag.MatchesTag(TAG_Equipment_Slot))
+		{
+			SlotTag = NewTag;
+			SetFlag(EInventorySlotFlags::Equipment);
+		}
+		else if (!SlotTag.IsValid())
+		{
+			SlotTag = NewTag;
+		}
+	}
+}
+
+
+void FInventorySlotData::PreReplicatedRemove(const FInventorySlotArray& InArraySerializer)
+{
+	InArraySerializer.bLayoutChanged = true;
+}
+
+
+void FInventorySlotData::PostReplicatedAdd(const FInventorySlotArray& InArraySerializer)
+{
+	InArraySerializer.bLayoutChanged = true;
+}
+
+
+void FInventorySlotData::PostReplicatedChange(const FInventorySlotArray& InArraySerializer)
+{
+	// A layout change rebuilds every slot once the update has been received.
+	// The fast array doesn't keep the client's order, so the slot goes by its replicated number.
+	if (InArraySerializer.bLayoutChanged || !IsValid(InArraySerializer.Owner)) { return; }
+	InArraySerializer.Owner->Helper_SlotReplicated(SlotNumber);
+}
+
+
+bool FInventorySlotArray::NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+{
+	// Returning false without writing leaves this connection's delta state where it was,
+	// so everything that changed in the meantime is sent once it becomes a viewer.
+	if (DeltaParms.Writer != nullptr && IsValid(Owner))
+	{
+		const UPackageMapClient* PackageMap = Cast<UPackageMapClient>(DeltaParms.Map);
+		if (IsValid(PackageMap) && !Owner->IsSlotViewer(PackageMap->GetConnection()))
+		{
+			return false;
+		}
+	}
+	const int64 StartBits = DeltaParms.Writer != nullptr ? DeltaParms.Writer->GetNumBits() : 0;
+	const bool bSerialized = FFastArraySerializer::FastArrayDeltaSerialize<FInventorySlotData, FInventorySlotArray>(
+		Items, DeltaParms, *this);
+	if (DeltaParms.Writer != nullptr && IsValid(Owner))
+	{
+		const int64 BytesWritten = (DeltaParms.Writer->GetNumBits() - StartBits + 7) / 8;
+		INC_DWORD_STAT_BY(STAT_InventoryBytesReplicated, BytesWritten);
+		Owner->BytesReplicated_ += BytesWritten;
+	}
+	return bSerialized;
+}
+
+
+void FInventorySlotArray::PostReplicatedReceive(
+	const FFastArraySerializer::FPostReplicatedReceiveParameters& Parameters)
+{
+	if (bLayoutChanged && IsValid(Owner))
+	{
+		Owner->Helper_SlotLayoutReplicated();
+	}
+	bLayoutChanged = false;
+}
@@ -146,10 +146,13 @@ FStItemData::FStItemData() :
  * @param OrderQuantity		The quantity requested to start with
  */
 FStItemData::FStItemData(const UItemDataAsset* NewData, const int OrderQuantity)
+	: FStItemData()
 {
-	Data = NewData->CopyAsset();
+	// The asset is immutable and shared by every instance of the item
+	Data = NewData;
 	if (IsValid(Data))
 	{
+		PrimaryAssetId	= Data->GetPrimaryAssetId();
 		const int NewQuantity = OrderQuantity > 0 ? OrderQuantity : 1;
 		const int MaxStackSize = Data->GetItemMaxStackSize();
 		
@@ -175,7 +178,7 @@ FStItemData::FStItemData(const FStItemData& OldItem, int OverrideQuantity)
 			else						{ItemQuantity = OldItem.ItemQuantity;}
 			DurabilityNow	= OldItem.Data->GetItemMaxDurability();
 			Rarity			= OldItem.Data->GetItemRarity();
-			Data			= OldItem.Data->CopyAsset();
+			Data			= OldItem.Data;
 			PrimaryAssetId = Data->GetPrimaryAssetId();
 			return;
 		}
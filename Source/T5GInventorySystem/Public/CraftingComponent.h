@@ -105,6 +105,8 @@ protected:
 	
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
+	virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+
 	// Conducts the 'tick', updating the crafting queue
 	virtual void DoCraftingTick();
 
@@ -131,6 +133,10 @@ private:
 	UPROPERTY(Replicated) UInventoryComponent* mInventoryInput;
 	UPROPERTY(Replicated) UInventoryComponent* mInventoryOutput;
 
+	// Replicated properties are push model; one bit per property marked dirty since last replication
+	static constexpr int NumPushProperties = 2;
+	uint32 DirtyPushProperties_ = 0;
+
 	UPROPERTY() FTimerHandle mCraftingTimer;
 
 	//UPROPERTY() FRWLock CraftingMutex;
@@ -10,8 +10,14 @@
 
 
 class UItemDataAsset;
+class UPackageMap;
 
 
+/**
+ * The per-instance values of an item. Every field is either an interned name or a plain value,
+ * so copying and comparing it never touches the heap. Replicated with a custom NetSerialize
+ * that only sends the fields that differ from their defaults.
+ */
 USTRUCT(Blueprintable)
 struct T5GINVENTORYSYSTEM_API FItemStatics
 {
@@ -23,39 +29,37 @@ struct T5GINVENTORYSYSTEM_API FItemStatics
 	// Used to create a whole new item
 	FItemStatics(const UItemDataAsset* DataAsset);
 
+	// The shared data asset of the item, if it is resident. Every instance of an item
+	// references the same asset; only the values in this struct are per instance.
+	const UItemDataAsset* GetItemData() const;
+
 	// The name of the Data Asset for this item
 	UPROPERTY(SaveGame, EditAnywhere, BlueprintReadWrite) FName			ItemName;
 	
 	UPROPERTY(SaveGame, EditAnywhere, BlueprintReadWrite) FGameplayTag	Rarity;
 	
+	// Negative means the item is unbreakable
 	UPROPERTY(SaveGame, EditAnywhere, BlueprintReadWrite) float			Durability;
 	
-	UPROPERTY(SaveGame, EditAnywhere, BlueprintReadWrite) FString		CrafterName;
+	// Interned in the name table, so crafted items don't each carry a string
+	UPROPERTY(SaveGame, EditAnywhere, BlueprintReadWrite) FName			CrafterName;
 	
 	UPROPERTY(SaveGame, EditAnywhere, BlueprintReadWrite) FDateTime		CraftTimestamp;
 	
-	UPROPERTY(SaveGame, EditAnywhere, BlueprintReadWrite) bool			bIsEquipped;
+	UPROPERTY(SaveGame, EditAnywhere, BlueprintReadWrite) uint8			bIsEquipped : 1;
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
 
 
+	// Every field is an interned name or a plain value, so this is a handful of integer compares.
+	// A crafter name is only required to match if the given statics have one.
 	bool operator==(const FItemStatics& InItemStatics) const
 	{
-		if (InItemStatics.ItemName != this->ItemName)
-		{ return false; }
-		if (!InItemStatics.Rarity.MatchesTagExact(this->Rarity))
-		{ return false; }
-		if (InItemStatics.Durability != this->Durability)
-		{ return false; }
-		if (!InItemStatics.CrafterName.IsEmpty() || CrafterName.IsEmpty())
-		{
-			if (InItemStatics.CrafterName != CrafterName)
-				{ return false; }
-		}
-		if (InItemStatics.CraftTimestamp != CraftTimestamp)
-		{
-			if (InItemStatics.CraftTimestamp != CraftTimestamp)
-				{ return false; }
-		}
-		return true;
+		return InItemStatics.ItemName == ItemName
+			&& InItemStatics.Rarity == Rarity
+			&& InItemStatics.Durability == Durability
+			&& (InItemStatics.CrafterName == CrafterName || (InItemStatics.CrafterName.IsNone() && !CrafterName.IsNone()))
+			&& InItemStatics.CraftTimestamp == CraftTimestamp;
 	}
 
 	bool operator!=(const FItemStatics& InItemStatics) const
@@ -63,4 +67,10 @@ struct T5GINVENTORYSYSTEM_API FItemStatics
 		return !(*this == InItemStatics);
 	}
 	
-};
\ No newline at end of file
+};
+
+template<>
+struct TStructOpsTypeTraits<FItemStatics> : public TStructOpsTypeTraitsBase2<FItemStatics>
+{
+	enum { WithNetSerializer = true };
+};
@@ -113,7 +113,7 @@ public:
 	UInventoryComponent* getOutputInventory() const { return mInventoryStatic; };
 
 	/**
-	 * An array of all FStItemData by FName that this fuel system allows.
+	 * An array of all fuel items that this fuel system allows.
 	 * Players will still be able to put anything in it, but only THESE items
 	 * will be counted for fuel consumption. Only read once during BeginPlay.
 	 * When searching the inventory for fuel, the system will consume
@@ -128,6 +128,8 @@ protected:
 	
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
+	virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+
 	void CheckForConsumption();
 
 	bool ConsumeQueuedItem();
@@ -170,5 +172,9 @@ private:
 	bool bShowDebug = false;
 
 	UPROPERTY() TArray<UFuelItemAsset*> mAuthorizedFuel;
+
+	// Replicated properties are push model; one bit per property marked dirty since last replication
+	static constexpr int NumPushProperties = 6;
+	uint32 DirtyPushProperties_ = 0;
 	
 };
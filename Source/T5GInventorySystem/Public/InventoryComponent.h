@@ -3,6 +3,7 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "Engine/StreamableManager.h"
 #include "lib/InventorySlot.h"
 #include "GameFramework/SaveGame.h"
 
@@ -11,7 +12,13 @@
 // Blueprints can only subscribe to dynamic delegates
 
 struct FInventorySlotSaveData;
+struct FInventoryStoreRecord;
+struct FInventorySlotSnapshot;
 class UInventoryDataAsset;
+class UNetConnection;
+class FInventoryTransaction;
+class APlayerController;
+
 /* Delegate that is called whenever a new notification is added to the item notification array.
  * Tells the client that there is an item to be processed.
  */
@@ -19,12 +26,25 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnNotificationAvailable);
 
 /* Delegate that is called on both client and server when an inventory update has occurred
  * Used so that other blueprints/classes can bind to it, running their own function when the inventory updates.
+ * Slots changed by an FInventoryTransaction are announced by OnTransactionCommitted instead.
  */
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnInventoryUpdated, int, slotNumber);
 
+/* Delegate that is called once per committed FInventoryTransaction, with every slot the transaction
+ * changed, in place of an OnInventoryUpdated per slot. Adds, removals, transfers and crafts all commit one.
+ */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnInventoryTransactionCommitted,
+											const TArray<int>&, SlotNumbers);
+
+/* Delegate that is called at most once per frame while bBatchSlotUpdates is set, with every
+ * slot that changed since the last call in ascending order. Meant for UI that redraws per call.
+ */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnInventoryBatchUpdated,
+											const TArray<int>&, SlotNumbers);
+
 /* Delegate that is called whenever an item is activated. */
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnItemActivated,
-		const FStItemData&, itemName, int, QuantityConsumed);
+		const FItemStatics&, ItemStatics, int, QuantityConsumed);
 
 /* Delegate that is called whenever the inventory is 'opened' or 'closed'. */
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnInventoryInUse,
@@ -33,12 +53,27 @@ const AActor*, InUseActor, const bool, IsInUse);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnInventoryRestored,
 											bool, bWasSuccessful);
 
+// Called once the item assets of every slot are loaded and the inventory is ready for use
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnInventoryReady);
+
+/* Delegate that is called when the total carry weight crosses one of the weight thresholds.
+ * WeightThreshold is the number of thresholds at or below the new total weight.
+ */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnWeightChanged,
+											float, TotalWeight, int, WeightThreshold);
+
 
 
 UCLASS(BlueprintType, Blueprintable, ClassGroup = (InventorySystem), meta = (BlueprintSpawnableComponent))
 class T5GINVENTORYSYSTEM_API UInventoryComponent : public UActorComponent
 {
     GENERATED_BODY()
+
+	// Fast array replication callbacks
+	friend struct FInventorySlotData;
+	friend struct FInventorySlotArray;
+	friend class UInventoryPersistenceSubsystem;
+	friend class FInventoryTransaction;
 	
 public:	//functions
 	
@@ -52,6 +87,12 @@ public:	//functions
      */
     UPROPERTY(BlueprintAssignable, Category = "Inventory Events")
 	FOnInventoryUpdated OnInventoryUpdated;
+
+	UPROPERTY(BlueprintAssignable, Category = "Inventory Events")
+	FOnInventoryTransactionCommitted OnTransactionCommitted;
+
+	UPROPERTY(BlueprintAssignable, Category = "Inventory Events")
+	FOnInventoryBatchUpdated OnInventoryBatchUpdated;
 	
 	UPROPERTY(BlueprintAssignable, Category = "Inventory Events")
 	FOnNotificationAvailable OnNotificationAvailable;
@@ -61,6 +102,12 @@ public:	//functions
 	
 	UPROPERTY(Blueprintable)
 	FOnInventoryRestored OnInventoryRestored;
+
+	UPROPERTY(BlueprintAssignable, Category = "Inventory Events")
+	FOnInventoryReady OnInventoryReady;
+
+	UPROPERTY(BlueprintAssignable, Category = "Inventory Events")
+	FOnWeightChanged OnWeightChanged;
 	
 	/**
 	 * ACCESSORS, MUTATORS & HELPERS
@@ -110,12 +157,18 @@ public:	//functions
     UFUNCTION(BlueprintPure, Category = "Inventory Accessors")
 	int GetFirstEmptySlotNumber() const;
 
+	UFUNCTION(BlueprintPure, Category = "Inventory Accessors")
+	int GetNumberOfEmptySlots(bool bEquipmentSlots = false) const;
+
 	UFUNCTION(BlueprintPure, Category = "Inventory Accessors")
 	float GetTotalWeightOfInventorySlots() const;
 
 	UFUNCTION(BlueprintPure, Category = "Inventory Accessors")
 	float GetTotalWeightOfEquipmentSlots() const;
 
+	UFUNCTION(BlueprintPure, Category = "Inventory Accessors")
+	float GetTotalWeight() const;
+
     UFUNCTION(BlueprintPure, Category = "Inventory Accessors")
 	float GetWeightOfSlotNumber(int SlotNumber) const;
 
@@ -164,6 +217,11 @@ public:	//functions
 	int AddItem(
 		const UInventorySlot* NewItem, int OrderQuantity, int SlotNumber = -1,
 		bool bAddOverflow = true, bool bDropOverflow = true, bool bNotify = false);
+
+	// Same as above, for items that are not in a slot yet (loot, pickups, byproducts)
+	int AddItem(
+		const FItemStatics& ItemStatics, int OrderQuantity, int SlotNumber = -1,
+		bool bAddOverflow = true, bool bDropOverflow = true, bool bNotify = false);
 	
     int AddItemFromDataAsset(
     	const UItemDataAsset* ItemDataAsset, int OrderQuantity, int SlotNumber,
@@ -183,6 +241,14 @@ public:	//functions
 		const FItemStatics& ItemReference, int OrderQuantity = 1,
 		bool bRemoveEquipment = false, bool bDropOnGround = false, bool bRemoveAll = false);
 
+	/**
+	 * Removes every item and quantity of the map as one transaction, or nothing at all
+	 * if any of them is short. Equipment slots are not included.
+	 * @return True if everything was removed
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Inventory Mutators")
+	bool RemoveItems(const TMap<FName, int>& ItemQuantities);
+
 	// Execute on the inventory losing the item
 	UFUNCTION(BlueprintCallable, Category = "Inventory Setters")
 	int RemoveItemFromSlot(
@@ -203,17 +269,85 @@ public:	//functions
 	UFUNCTION(BlueprintCallable)
 	bool SetInventoryDebugMode(const bool bEnable = true) { return (bShowDebug = bEnable); };
 
+	UFUNCTION(BlueprintPure)
+	bool GetInventoryDebugMode() const { return bShowDebug; }
+
+	// Bytes this inventory's slots have written to all connections so far, for profiling
+	UFUNCTION(BlueprintPure, Category = "Inventory Accessors")
+	int64 GetBytesReplicated() const { return BytesReplicated_; }
+
 	UFUNCTION(BlueprintCallable)
 	bool ActivateSlot(int SlotNumber, bool bForceConsume = false);
+
+	// Server Only. Starts replicating the slot contents to the given player.
+	void AddViewer(const APlayerController* Viewer);
+
+	// Server Only. Stops replicating the slot contents to the given player.
+	void RemoveViewer(const APlayerController* Viewer);
+
+	// True if the slot contents replicate to the given connection
+	bool IsSlotViewer(const UNetConnection* Connection) const;
+
+	// Replicates to everyone, including players who are not viewing this inventory
+	UFUNCTION(BlueprintPure, Category = "Inventory Accessors")
+	bool GetContainsItems() const { return bContainsItems_; }
+
+	// Returns a UObject view of the slot for Blueprint/UI, creating it on first request.
+	UFUNCTION(BlueprintCallable, Category = "Inventory Accessors")
+	UInventorySlot* GetInventorySlot(int SlotNumber);
+
+	// Read-only access to the packed slot data. Invalid slot numbers return an empty slot.
+	const FInventorySlotData& GetSlotData(int SlotNumber) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Inventory Mutators")
+	int SetSlotItem(int SlotNumber, const FItemStatics& ItemStatics, int NewQuantity = 1);
+
+	UFUNCTION(BlueprintCallable, Category = "Inventory Mutators")
+	int SetSlotQuantity(int SlotNumber, int NewQuantity);
+
+	UFUNCTION(BlueprintCallable, Category = "Inventory Mutators")
+	bool SetSlotDurability(int SlotNumber, float NewDurability);
+
+	UFUNCTION(BlueprintCallable, Category = "Inventory Mutators")
+	int IncreaseSlotQuantity(int SlotNumber, int OrderQuantity = 1, bool bNotify = false);
+	
+	UFUNCTION(BlueprintCallable, Category = "Inventory Mutators")
+	int DecreaseSlotQuantity(int SlotNumber, int OrderQuantity = 1, bool bNotify = false);
+
+	// Run immediately when called on the server
+	UFUNCTION(Server, Reliable, BlueprintCallable)
+	void Server_TransferItems(
+		UInventoryComponent* OriginInventory, UInventoryComponent* TargetInventory,
+		int OriginSlotNumber, int TargetSlotNumber, int OrderQuantity = 1);
+	
+	UFUNCTION(Server, Reliable, BlueprintCallable)
+	void Server_DropItemOnGround(
+		UInventoryComponent* OriginInventory, int SlotNumber, int OrderQuantity = 1);
 	
 	
 protected:
 
+	// Points the slots back at this inventory, since the archetype copy carries the template's owner
+	virtual void PostInitProperties() override;
+
+	virtual void PostDuplicate(bool bDuplicateForPIE) override;
+
+	virtual void OnRegister() override;
+
 	virtual void BeginPlay() override;
+
+	// Hands unsaved changes to the persistence service, which only holds a weak pointer to this
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	
 	virtual void GetLifetimeReplicatedProps(
 		TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
 	
+	// Broadcasts OnInventoryBatchUpdated now, instead of waiting for the next frame
+	UFUNCTION(BlueprintCallable, Category = "Inventory Events")
+	void FlushSlotUpdates();
+
 	UFUNCTION(BlueprintCallable, Category = "Inventory Setters")
 	int SwapOrStackSlots(
 		UInventorySlot* OriginSlot, UInventorySlot* TargetSlot, int& RemainingQuantity);
@@ -227,18 +361,12 @@ protected:
 	void Server_RequestItemActivation(
 		UInventoryComponent* OriginInventory, int SlotNumber = 0);
 	
-	UFUNCTION(Server, Reliable, BlueprintCallable)
-	void Server_TransferItems(
-		UInventoryComponent* OriginInventory, UInventoryComponent* TargetInventory,
-		int OriginSlotNumber, int TargetSlotNumber, int OrderQuantity = 1);
-	
-	UFUNCTION(Server, Reliable, BlueprintCallable)
-	void Server_DropItemOnGround(
-		UInventoryComponent* OriginInventory, int SlotNumber, int OrderQuantity = 1);
-	
 	UFUNCTION(Server, Reliable, BlueprintCallable)
 	void Server_RequestOtherInventory(UInventoryComponent* TargetInventory);
 
+	UFUNCTION(Server, Reliable, BlueprintCallable)
+	void Server_CloseOtherInventory(UInventoryComponent* TargetInventory);
+
 	UFUNCTION(Client, Reliable)	void Client_InventoryRestored();
 	
 	UFUNCTION(Server, Reliable)
@@ -246,28 +374,126 @@ protected:
 		const TArray<FInventorySlotSaveData>& RestoredInventory);
 	
 	void RestoreInventory(const TArray<FInventorySlotSaveData>& RestoredInventory);
-    
-	UInventorySlot* GetInventorySlot(int SlotNumber) const;
 
 	int GetSlotNumber(const UInventorySlot* SlotReference) const;
     
-	TArray<UInventorySlot*> GetAllSlots() const;
+	TArrayView<const FInventorySlotData> GetAllSlots() const;
 	
-	TArray<UInventorySlot*> GetAllInventorySlots() const;
+	TArrayView<const FInventorySlotData> GetAllInventorySlots() const;
 	
-	TArray<UInventorySlot*> GetAllEquipmentSlots() const;
-
-	UFUNCTION(BlueprintCallable, BlueprintCallable, Category = "Inventory Mutators")
-	int IncreaseSlotQuantity(int SlotNumber, int OrderQuantity = 1, bool bNotify = false);
-	
-	UFUNCTION(BlueprintCallable, BlueprintCallable, Category = "Inventory Mutators")
-	int DecreaseSlotQuantity(int SlotNumber, int OrderQuantity = 1, bool bNotify = false);
+	TArrayView<const FInventorySlotData> GetAllEquipmentSlots() const;
 
 private: //functions
 
 	UFUNCTION() virtual void NotifySlotUpdated(const int SlotNumber);
 
-	void Helper_SaveInventory(USaveGame*& SaveData) const;
+	/**
+	 * Slot mutation primitives. These do not take the InventoryMutex, so the
+	 * caller is expected to hold the write lock. Every change to the packed
+	 * slot data goes through here and ends in Helper_SlotChanged. While an
+	 * FInventoryTransaction is active, the change is only recorded until it commits.
+	 * Otherwise the caller publishes it with Helper_BroadcastPendingSlotChanges
+	 * once the lock has been released.
+	 */
+	int Helper_SetSlotItem(int SlotNumber, const FItemStatics& ItemStatics,
+		int NewQuantity, const UItemDataAsset* ItemData = nullptr);
+
+	int Helper_SetSlotQuantity(int SlotNumber, int NewQuantity);
+
+	// The data asset of the item if it is resident. If not, it is requested through Helper_RequestAssets
+	// and nullptr is returned; adds are planned with the stack size from the asset registry meanwhile.
+	const UItemDataAsset* Helper_RequestItemData(const FItemStatics& ItemStatics);
+
+	// Works out where the item would go without changing any slot. Caller must hold the lock.
+	void Helper_PlanAddItem(const FItemStatics& ItemStatics, int OrderQuantity,
+		int SlotNumber, bool bAddOverflow, FInventoryAddPlan& OutPlan, int SkipSlotNumber = -1) const;
+
+	void Helper_SlotChanged(int SlotNumber, const FInventorySlotData& PreviousSlot);
+
+	// Publishes the changes Helper_SlotChanged queued. Call after releasing the lock.
+	void Helper_BroadcastPendingSlotChanges();
+
+	// Item index, occupancy and weight bookkeeping of a change. Broadcasts nothing.
+	void Helper_UpdateSlotState(int SlotNumber, const FInventorySlotData& PreviousSlot);
+
+	// Server side. Queues the slot for replication and persistence.
+	void Helper_MarkSlotDirty(int SlotNumber);
+
+	// bNotifyInventory false leaves out OnInventoryUpdated, for a transaction that announces all its slots at once
+	void Helper_BroadcastSlotChanged(int SlotNumber, const UItemDataAsset* PreviousItem, bool bNotifyInventory = true);
+
+	// Adds the slot to the next OnInventoryBatchUpdated, if batching is on
+	void Helper_QueueBatchedSlotUpdate(int SlotNumber);
+
+	// Client side. Called by the slot fast array when a single slot was replicated.
+	void Helper_SlotReplicated(int SlotNumber);
+
+	// Client side. Called by the slot fast array when slots were added or removed.
+	void Helper_SlotLayoutReplicated();
+
+	// Item index maintenance. Same locking rules as the slot primitives.
+	void Helper_AddToItemIndex(int SlotNumber, const FInventorySlotData& InventorySlot);
+
+	void Helper_RemoveFromItemIndex(int SlotNumber, const FInventorySlotData& InventorySlot);
+
+	void Helper_RebuildItemIndex();
+
+	// Keeps the empty-slot bitsets, their counts and bInventoryFull in sync with the slot
+	void Helper_UpdateSlotOccupancy(int SlotNumber);
+
+	void Helper_RebuildSlotOccupancy();
+
+	// Server only. Keeps the replicated bContainsItems_ summary up to date.
+	void Helper_UpdateContainsItems();
+
+	void Helper_UpdateSlotPartition();
+
+	void Helper_RebuildEquipmentSlotMap();
+
+	void Helper_RebuildWeight();
+
+	void Helper_CheckWeightThreshold();
+
+	// Resolves the data asset of the slot, loading it through the asset manager if required
+	void Helper_LoadSlotAsset(int SlotNumber);
+
+	// Requests the item assets of every slot that are not resident yet, in a single batch.
+	// If bMarkReady is true, the inventory becomes ready once they have loaded.
+	void Helper_PreloadSlotAssets(bool bMarkReady);
+
+	// Issues one streamable request for the assets and keeps its handle, so they stay loaded.
+	// If bMarkReady is true and nothing is loading, the inventory is ready immediately.
+	void Helper_RequestAssets(const TArray<FPrimaryAssetId>& AssetIds, bool bMarkReady);
+
+	// True while any of AssetHandles_ has not finished loading
+	bool Helper_IsLoadingAssets() const;
+
+	void Helper_MarkReadyIfLoaded(bool bDeferBroadcast);
+
+	// Resolves every slot that was waiting for its asset
+	void SlotAssetsLoaded();
+
+	// Copies the persistent slot state under a read lock, for serialization off the game thread
+	void Helper_TakeSlotSnapshot(TArray<FInventorySlotSnapshot>& OutSnapshot);
+
+	// Copies every slot into its save representation
+	void Helper_GetSaveSlots(TArray<FInventorySlotSaveData>& OutSaveSlots) const;
+
+	// The save slot name, generating a unique one if this inventory has never been saved
+	const FString& Helper_GetPersistenceId();
+
+	// Server only. Queues this inventory for the next batched save of the persistence service.
+	void Helper_MarkPersistenceDirty();
+
+	// Fills the record with the slots changed since the previous record, or with every slot if a
+	// full record is due. False if nothing changed. Marks the changes as persisted.
+	bool Helper_GetPersistenceRecord(FInventoryStoreRecord& OutRecord, int MaxDeltaRecords);
+
+	// The previous record never reached the store, so the next one has to be a full record
+	void Helper_PersistenceFailed();
+
+	// Called when the slot layout is rebuilt, which invalidates any delta against the stored layout
+	void Helper_ResetSlotGenerations();
 
 	bool Helper_CreateItem(const FPrimaryAssetId& AssetId);
 	
@@ -301,6 +527,26 @@ public: //variables
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	FString SaveFolder = "";
 
+	// If true, saves go through the world's UInventoryPersistenceSubsystem, which writes every
+	// changed inventory in one batch instead of one save file per inventory.
+	// The save slot name is then the id of the inventory in the shared store.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Inventory Settings")
+	bool bUsePersistenceService = false;
+
+	// If true, slot contents only replicate to the owner and to players who have this inventory open
+	// (see Server_RequestOtherInventory). Everyone else only receives GetContainsItems().
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Inventory Settings")
+	bool bReplicateToViewersOnly = false;
+
+	// Carry weights at which OnWeightChanged fires, such as encumbrance levels
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Inventory Settings")
+	TArray<float> WeightThresholds;
+
+	// If true, changed slots are collected and announced once per frame through OnInventoryBatchUpdated.
+	// OnInventoryUpdated and OnTransactionCommitted still fire either way.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Inventory Settings")
+	bool bBatchSlotUpdates = false;
+
 	
 protected: //variables
 
@@ -333,17 +579,70 @@ private: //variables
 	 */
 	FRWLock InventoryMutex;
 
+	// Holds the write lock of InventoryMutex while set
+	FInventoryTransaction* ActiveTransaction_ = nullptr;
+
+	// Slot changes made outside a transaction, with the item each slot held before,
+	// waiting to be broadcast once the lock is released
+	TArray<TPair<int, const UItemDataAsset*>> PendingSlotBroadcasts_;
+
 	void MapEquipmentSlot(const FGameplayTag& EquipmentTag, int SlotNumber);
 	
-	UFUNCTION(NetMulticast, Reliable)
-	void OnRep_InventorySlotUpdated(const TArray<UInventorySlot*>& OldSlots);
-	
 	UFUNCTION(NetMulticast, Reliable)
 	void OnRep_NewNotification();
 
-	// TODO - Replace replication with a custom replication method, so that we save network resources
-	UPROPERTY(ReplicatedUsing = OnRep_InventorySlotUpdated)
-	TArray<UInventorySlot*> InventorySlots_;
+	// Connections that currently have this inventory open
+	TArray<TWeakObjectPtr<UNetConnection>> Viewers_;
+
+	// Summary for connections that don't receive the slots
+	UPROPERTY(Replicated)
+	bool bContainsItems_ = false;
+
+	// Packed slot storage. The array index is the slot number.
+	// Delta replicated; changes arrive through Helper_SlotReplicated/Helper_SlotLayoutReplicated.
+	UPROPERTY(Replicated)
+	FInventorySlotArray InventorySlots_;
+
+	// UObject views of InventorySlots_, only created when requested through GetInventorySlot
+	UPROPERTY(Transient)
+	TArray<UInventorySlot*> SlotObjects_;
+
+	// Item name to the slots holding it, so stack and count lookups don't scan every slot
+	TMap<FName, FInventoryItemIndexEntry> ItemIndex_;
+
+	// One bit per slot, set while the slot is empty. Equipment slots are never
+	// set in the inventory mask, and inventory slots never in the equipment mask.
+	TBitArray<> EmptyInventorySlots_;
+
+	TBitArray<> EmptyEquipmentSlots_;
+
+	// Set bits of each mask, kept as the bits flip
+	int NumEmptyInventorySlots_ = 0;
+
+	int NumEmptyEquipmentSlots_ = 0;
+
+	// Inventory slots are [0, EquipmentSlotsStart_), equipment slots are the rest
+	int EquipmentSlotsStart_ = 0;
+
+	// Running weight totals, updated by delta whenever a slot changes
+	float InventoryWeight_ = 0.f;
+
+	float EquipmentWeight_ = 0.f;
+
+	// How many of the WeightThresholds the total weight is at or above
+	int WeightThreshold_ = 0;
+
+	// One bit per slot, set while the slot has a change waiting for OnInventoryBatchUpdated
+	TBitArray<> PendingSlotUpdates_;
+
+	bool bSlotUpdateFlushPending_ = false;
+
+	// Counted by the slot array's NetDeltaSerialize
+	int64 BytesReplicated_ = 0;
+
+	// Replicated properties are push model; one bit per property marked dirty since last replication
+	static constexpr int NumPushProperties = 3;
+	uint32 DirtyPushProperties_ = 0;
 	
 	bool bInventoryReady = false;
 
@@ -360,8 +659,36 @@ private: //variables
 	// Used to prevent clients from cheating their inventory
 	bool bInventoryRestored = false;
 
-#ifdef UE_BUILD_DEBUG
-	bool bShowDebug = true;
-#endif
+	// Keep the item assets requested by this inventory loaded
+	TArray<TSharedPtr<FStreamableHandle>> AssetHandles_;
+
+	// Assets already covered by AssetHandles_
+	TSet<FPrimaryAssetId> RequestedAssets_;
+
+	// A request asked for bInventoryReady once every asset in flight has loaded
+	bool bReadyWhenLoaded_ = false;
+
+	// Already queued with the persistence service
+	bool bPersistenceDirty_ = false;
+
+	// Value of SlotGeneration_ when each slot last changed
+	TArray<uint32> SlotGenerations_;
+
+	// Incremented on every slot change
+	uint32 SlotGeneration_ = 0;
+
+	// SlotGeneration_ when the last persistence record was taken. Newer slots go into the next delta.
+	uint32 PersistedGeneration_ = 0;
+
+	// Delta records written since the last full record
+	int PersistedDeltas_ = 0;
+
+	// The stored record can't be built on (layout changed, or nothing stored yet)
+	bool bPersistFullRecord_ = true;
+
+	// Logs every operation on this inventory to LogInventory. The property exists in every build,
+	// but shipping builds compile out the messages below Warning (see InventoryLog.h).
+	UPROPERTY(EditAnywhere, Category = "Inventory Settings")
+	bool bShowDebug = false;
 	
 };
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Logging/LogMacros.h"
+#include "Logging/StructuredLog.h"
+
+/**
+ * Most verbose LogInventory messages compiled into the build. Anything more verbose is
+ * removed along with the evaluation of its arguments. Can be overridden from the target.
+ */
+#ifndef INVENTORY_LOG_COMPILETIME_VERBOSITY
+	#if UE_BUILD_SHIPPING
+		#define INVENTORY_LOG_COMPILETIME_VERBOSITY Warning
+	#else
+		#define INVENTORY_LOG_COMPILETIME_VERBOSITY All
+	#endif
+#endif
+
+T5GINVENTORYSYSTEM_API DECLARE_LOG_CATEGORY_EXTERN(LogInventory, Log, INVENTORY_LOG_COMPILETIME_VERBOSITY);
+
+#if NO_LOGGING
+
+#define INVENTORY_DEBUG_LOG(bDebugEnabled, Verbosity, Format, ...) do {} while (0)
+
+#else
+
+// True if LogInventory keeps messages of the verbosity in this build
+#define INVENTORY_LOG_ACTIVE(Verbosity) \
+	((ELogVerbosity::Verbosity & ELogVerbosity::VerbosityMask) <= ELogVerbosity::COMPILED_IN_MINIMUM_VERBOSITY \
+	&& (ELogVerbosity::Verbosity & ELogVerbosity::VerbosityMask) <= FLogCategoryLogInventory::CompileTimeVerbosity)
+
+/**
+ * Logs to LogInventory only while bDebugEnabled is true, such as an inventory's bShowDebug.
+ * Used for the per-operation messages on hot paths. Neither the condition nor the arguments
+ * are evaluated when the verbosity is compiled out.
+ */
+#define INVENTORY_DEBUG_LOG(bDebugEnabled, Verbosity, Format, ...) \
+	do \
+	{ \
+		if constexpr (INVENTORY_LOG_ACTIVE(Verbosity)) \
+		{ \
+			if (bDebugEnabled) \
+			{ \
+				UE_LOGFMT(LogInventory, Verbosity, Format, ##__VA_ARGS__); \
+			} \
+		} \
+	} while (0)
+
+#endif
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "lib/InventorySave.h"
+
+#include "InventoryPersistenceSubsystem.generated.h"
+
+class UInventoryComponent;
+
+
+// One inventory as handed to the background writer
+struct FInventoryStoreRecord
+{
+	FString InventoryId;
+
+	// Full records hold every slot. Delta records only hold the slots in 'SlotNumbers'.
+	bool bFullRecord = true;
+	TArray<int> SlotNumbers;
+	TArray<FInventorySlotSaveData> InventorySlots;
+
+	// The inventory that produced the record, to fall back to a full record if the write fails
+	TWeakObjectPtr<UInventoryComponent> Inventory;
+};
+
+
+// Where a record lives in the store file
+struct FInventoryStoreSpan
+{
+	int64 Offset = 0;
+	int64 Size = 0;
+};
+
+
+// A record written by a background task, in file order
+struct FInventoryStoreWrittenRecord
+{
+	FString InventoryId;
+	bool bFullRecord = true;
+	FInventoryStoreSpan Span;
+};
+
+
+struct FInventoryStoreTaskResult
+{
+	bool bSuccess = false;
+
+	// True if the store was rewritten, so 'Records' replaces the whole index
+	bool bCompaction = false;
+	TArray<FInventoryStoreWrittenRecord> Records;
+
+	// The records that were meant to be written, for the failure path
+	TArray<FInventoryStoreRecord> FailedRecords;
+
+	// False if a failed append could not be cut back off the store
+	bool bStoreIntact = true;
+};
+
+
+/**
+ * Batches the saves of every inventory in the world into a single append-only store file.
+ * Inventories with 'bUsePersistenceService' mark themselves dirty when a slot changes, and
+ * the dirty set is written on a background thread every 'FlushInterval' seconds, replacing
+ * one save file and one async task per inventory. Records are looked up by inventory id
+ * when an inventory loads; the store index is only built on the first lookup.
+ *
+ * The store is a journal: an inventory writes a full record, followed by delta records of
+ * only the slots that changed since its previous record. Once the file has grown to
+ * 'CompactionRatio' times its live records, it is rewritten without the dead ones.
+ */
+UCLASS(Config = Game)
+class T5GINVENTORYSYSTEM_API UInventoryPersistenceSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	virtual void Deinitialize() override;
+
+	// Queues the inventory for the next flush
+	void MarkInventoryDirty(UInventoryComponent* Inventory);
+
+	// Takes the unsaved changes of an inventory that is ending play, which the next flush writes
+	// even though the inventory itself is gone by then
+	void ReleaseInventory(UInventoryComponent* Inventory);
+
+	// Writes all dirty inventories now. Does nothing while the previous write is still running.
+	UFUNCTION(BlueprintCallable)
+	void Flush();
+
+	/**
+	 * Reads the latest record of the inventory id. False if the store has no (valid) record for it.
+	 * Runs on the game thread. If the background write holds a record of this id, or is compacting
+	 * the store, it blocks until that write finishes ('Load Waiting On Store Write' in stat Inventory).
+	 */
+	bool LoadInventorySlots(const FString& InventoryId, TArray<FInventorySlotSaveData>& OutInventorySlots);
+
+	// Seconds between flushes of the dirty inventories
+	UPROPERTY(Config)
+	float FlushInterval = 30.f;
+
+	// File name of the store, relative to the save game directory
+	UPROPERTY(Config)
+	FString StoreName = "InventoryStore.bin";
+
+	// Codec for the slot payloads of new records. Records with any codec, or none, can be read.
+	UPROPERTY(Config)
+	EInventorySaveCompression StoreCompression = EInventorySaveCompression::None;
+
+	// Delta records an inventory writes before it writes a full record again, which bounds the load cost
+	UPROPERTY(Config)
+	int MaxDeltaRecords = 16;
+
+	// Store size relative to its live records at which the store is compacted
+	UPROPERTY(Config)
+	float CompactionRatio = 2.f;
+
+	// Stores smaller than this are never compacted
+	UPROPERTY(Config)
+	int64 MinCompactionSize = 1024 * 1024;
+
+protected:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	FString GetStorePath() const;
+
+	// Scans the record headers of the store, remembering the offset of the latest record per id
+	void Helper_BuildStoreIndex();
+
+	// Moves the offsets of a finished task into the index. Blocks until the task finishes if bWait is true.
+	void Helper_FinishPendingWrite(bool bWait);
+
+	void Helper_AddToStoreIndex(const FInventoryStoreWrittenRecord& Record);
+
+	// Starts a rewrite of the store if enough of it is dead records
+	void Helper_CompactIfNeeded();
+
+	TSet<TWeakObjectPtr<UInventoryComponent>> DirtyInventories_;
+
+	// Records of inventories that ended play before the next flush
+	TArray<FInventoryStoreRecord> ReleasedRecords_;
+
+	// The records needed to restore each inventory id: its latest full record, then its deltas
+	TMap<FString, TArray<FInventoryStoreSpan>> StoreIndex_;
+
+	bool bStoreIndexBuilt_ = false;
+
+	// Bytes of the records in StoreIndex_, and of the whole store file
+	int64 LiveStoreSize_ = 0;
+	int64 StoreSize_ = 0;
+
+	// The background write or compaction. Only one runs at a time.
+	TFuture<FInventoryStoreTaskResult> PendingWrite_;
+
+	// The inventory ids the running write appends records for
+	TSet<FString> PendingWriteIds_;
+
+	bool bPendingCompaction_ = false;
+
+	// False until an append of this session has checked that the store ends on an intact record.
+	// Cleared again when an append fails and leaves part of its batch behind.
+	bool bStoreIntact_ = false;
+
+	FTimerHandle FlushTimer_;
+};
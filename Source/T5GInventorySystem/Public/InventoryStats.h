@@ -0,0 +1,82 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Net/Core/PushModel/PushModel.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Trace/Trace.h"
+
+DECLARE_STATS_GROUP(TEXT("Inventory"), STATGROUP_Inventory, STATCAT_Advanced);
+
+// Insights channel of the inventory scopes. Enable with -trace=cpu,inventory
+UE_TRACE_CHANNEL_EXTERN(InventoryChannel, T5GINVENTORYSYSTEM_API);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("AddItem"),
+	STAT_InventoryAddItem, STATGROUP_Inventory, T5GINVENTORYSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("RemoveItemByQuantity"),
+	STAT_InventoryRemoveItem, STATGROUP_Inventory, T5GINVENTORYSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("TransferItems"),
+	STAT_InventoryTransferItems, STATGROUP_Inventory, T5GINVENTORYSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("SaveInventory"),
+	STAT_InventorySave, STATGROUP_Inventory, T5GINVENTORYSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("LoadInventory"),
+	STAT_InventoryLoad, STATGROUP_Inventory, T5GINVENTORYSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Load Waiting On Store Write"),
+	STAT_InventoryStoreWriteWait, STATGROUP_Inventory, T5GINVENTORYSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Slot Replicated"),
+	STAT_InventorySlotReplicated, STATGROUP_Inventory, T5GINVENTORYSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Fuel Consumption"),
+	STAT_InventoryFuelConsumption, STATGROUP_Inventory, T5GINVENTORYSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Crafting Tick"),
+	STAT_InventoryCraftingTick, STATGROUP_Inventory, T5GINVENTORYSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Pickup Overlap"),
+	STAT_InventoryPickupOverlap, STATGROUP_Inventory, T5GINVENTORYSYSTEM_API);
+
+// Slots visited by searches, placement plans and rebuilds
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Slots Scanned"),
+	STAT_InventorySlotsScanned, STATGROUP_Inventory, T5GINVENTORYSYSTEM_API);
+
+// Item assets requested from the asset manager
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Asset Loads Issued"),
+	STAT_InventoryAssetLoads, STATGROUP_Inventory, T5GINVENTORYSYSTEM_API);
+
+// Bytes written by the slot arrays of all inventories. Each inventory also keeps its own total.
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Slot Bytes Replicated"),
+	STAT_InventoryBytesReplicated, STATGROUP_Inventory, T5GINVENTORYSYSTEM_API);
+
+// Push model properties that were still clean when their component replicated,
+// which the net driver therefore did not have to compare.
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Push Model Compares Avoided"),
+	STAT_InventoryPushComparesAvoided, STATGROUP_Inventory, T5GINVENTORYSYSTEM_API);
+
+/**
+ * Times the enclosing scope for 'stat Inventory' and as a named event on the InventoryChannel.
+ * @param StatName One of the cycle stats above
+ */
+#define INVENTORY_SCOPE_CYCLE_COUNTER(StatName) \
+	SCOPE_CYCLE_COUNTER(StatName); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR(#StatName, InventoryChannel)
+
+/**
+ * Marks a push model property dirty, and remembers it as compared for the stat above.
+ * The calling class needs a 'uint32 DirtyPushProperties_' member with one bit per replicated
+ * property, which it resets in PreReplication.
+ */
+#define MARK_INVENTORY_PROPERTY_DIRTY(ClassName, PropertyName) \
+	{ \
+		MARK_PROPERTY_DIRTY_FROM_NAME(ClassName, PropertyName, this); \
+		DirtyPushProperties_ |= 1u << ((uint32)ClassName::ENetFields_Private::PropertyName \
+			- (uint32)ClassName::ENetFields_Private::NETFIELD_REP_START); \
+	}
+
+/**
+ * Adds the push model properties that were not dirtied since the last replication to the stat.
+ * Called from PreReplication of each component using MARK_INVENTORY_PROPERTY_DIRTY.
+ * A property marked several times is still only one compare.
+ */
+#define COUNT_INVENTORY_PUSH_COMPARES_AVOIDED(NumPushProperties) \
+	{ \
+		INC_DWORD_STAT_BY(STAT_InventoryPushComparesAvoided, \
+			FMath::Max((NumPushProperties) - (int)FMath::CountBits(DirtyPushProperties_), 0)); \
+		DirtyPushProperties_ = 0; \
+	}
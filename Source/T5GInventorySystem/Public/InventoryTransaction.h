@@ -0,0 +1,103 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "lib/InventorySlotData.h"
+
+class UInventoryComponent;
+
+
+/**
+ * Scoped batch of changes to one inventory. Takes the inventory's write lock once for
+ * its whole lifetime, so its operations must not be mixed with calls that lock the
+ * inventory themselves. Changes apply to the slots right away, so later operations see
+ * the earlier ones, but nothing replicates or broadcasts until Commit(), which announces
+ * every changed slot in one OnTransactionCommitted.
+ *
+ * If any operation could not be applied in full, or Fail() was called, Commit() rolls
+ * every touched slot back instead. A transaction that is never committed rolls back
+ * when it goes out of scope.
+ *
+ *	FInventoryTransaction Transaction(Inventory);
+ *	Transaction.RemoveItem(WoodName, 4);
+ *	Transaction.RemoveItem(NailName, 12);
+ *	Transaction.AddItem(ChairStatics, 1);
+ *	const bool bCrafted = Transaction.Commit();
+ */
+class T5GINVENTORYSYSTEM_API FInventoryTransaction
+{
+public:
+
+	explicit FInventoryTransaction(UInventoryComponent* InInventory);
+
+	~FInventoryTransaction();
+
+	FInventoryTransaction(const FInventoryTransaction&) = delete;
+	FInventoryTransaction& operator=(const FInventoryTransaction&) = delete;
+
+	/**
+	 * Adds the item, topping up partial stacks of the exact same item before using empty slots.
+	 * @param SlotNumber If not negative, this slot is filled first
+	 * @param bAddOverflow If false, the add goes into a single slot: SlotNumber if one was given,
+	 *                     otherwise the first slot the item fits in
+	 * @param bAllOrNothing If true, the transaction fails unless the whole quantity fits
+	 * @param SkipSlotNumber If not negative, this slot is never filled (the origin of a transfer)
+	 * @return The number of items added. Negative indicates failure.
+	 */
+	int AddItem(const FItemStatics& ItemStatics, int OrderQuantity, int SlotNumber = -1,
+		bool bAddOverflow = true, bool bAllOrNothing = true, int SkipSlotNumber = -1);
+
+	/**
+	 * Removes the item from the lowest slots holding it
+	 * @param bRemoveEquipment If true, equipment slots are included
+	 * @param bAllOrNothing If true, the transaction fails unless the whole quantity was removed
+	 * @return The number of items removed. Negative indicates failure.
+	 */
+	int RemoveItem(const FName& ItemName, int OrderQuantity, bool bRemoveEquipment = false, bool bAllOrNothing = true);
+
+	// Removes from one slot. Same return and failure rules as RemoveItem.
+	int RemoveFromSlot(int SlotNumber, int OrderQuantity, bool bAllOrNothing = true);
+
+	// Returns the new quantity of the slot. Negative indicates failure, and fails the transaction.
+	int SetSlotItem(int SlotNumber, const FItemStatics& ItemStatics, int NewQuantity);
+
+	// Returns the new quantity of the slot. Negative indicates failure, and fails the transaction.
+	int SetSlotQuantity(int SlotNumber, int NewQuantity);
+
+	// Fails the transaction, for callers that validate on their own
+	void Fail() { bFailed_ = true; }
+
+	bool HasFailed() const { return bFailed_; }
+
+	/**
+	 * Publishes every change at once, or rolls them all back if the transaction failed.
+	 * Releases the lock before anything is broadcast.
+	 * @return True if the changes were kept
+	 */
+	bool Commit();
+
+	// Restores every slot touched so far to its state from before the transaction
+	void Rollback();
+
+	// The slots touched by the transaction, in the order they were first changed
+	const TArray<int>& GetChangedSlots() const { return ChangedSlots_; }
+
+private:
+
+	friend class UInventoryComponent;
+
+	// Called by the inventory for every slot change while this transaction is active
+	void Helper_RecordSlotChange(int SlotNumber, const FInventorySlotData& PreviousSlot);
+
+	void Helper_Unlock();
+
+	UInventoryComponent* Inventory_ = nullptr;
+
+	// The state of each touched slot from before the transaction, parallel to ChangedSlots_
+	TArray<FInventorySlotData> OriginalSlots_;
+
+	TArray<int> ChangedSlots_;
+
+	bool bLocked_ = false;
+
+	bool bFailed_ = false;
+};
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+
+#include "ItemDefinitionSubsystem.generated.h"
+
+class UItemDataAsset;
+
+// Dense id of an item definition, valid for the lifetime of the process. Zero is no item.
+using FItemDefinitionId = uint16;
+
+
+/**
+ * The fields of an item data asset that inventories read on their hot paths,
+ * copied into a flat table so slots don't have to go through the asset.
+ * The hot fields are only filled once the asset has been resident ('bResolved'), except for
+ * the stack size, which is read from the asset registry when the definition is added.
+ */
+struct T5GINVENTORYSYSTEM_API FItemDefinition
+{
+	FName ItemName;
+
+	FPrimaryAssetId AssetId;
+
+	TWeakObjectPtr<const UItemDataAsset> DataAsset;
+
+	bool bResolved = false;
+
+	int MaxStackSize = 1;
+
+	// Set once MaxStackSize came from the asset registry or the asset. Assets saved before it
+	// was searchable have no tag until they are resaved.
+	bool bStackSizeKnown = false;
+
+	float CarryWeight = 0.f;
+
+	float MaxDurability = 0.f;
+
+	bool bCanActivate = false;
+
+	// Bits of the equipment slot tags and category tags, as handed out by FItemDefinitionCache
+	uint32 EquippableSlotMask = 0;
+
+	uint32 CategoryMask = 0;
+
+	// The tags that got no bit because all 32 were taken, compared tag by tag instead
+	FGameplayTagContainer UnmappedEquippableSlots;
+
+	FGameplayTagContainer UnmappedCategories;
+
+	bool CanEquipInSlot(const FGameplayTag& SlotTag) const;
+
+	bool HasCategory(const FGameplayTag& CategoryTag) const;
+};
+
+
+/**
+ * Process-wide table of item definitions, indexed by FItemDefinitionId. Ids are handed
+ * out by UItemDefinitionSubsystem when the game instance starts, in name order, and items
+ * that were not known then get the next free id when they are first seen.
+ * Only accessed from the game thread.
+ */
+class T5GINVENTORYSYSTEM_API FItemDefinitionCache
+{
+public:
+
+	static FItemDefinitionCache& Get();
+
+	// The primary asset type every item is registered under
+	static const FPrimaryAssetType& GetItemAssetType();
+
+	// Assigns ids to every item the asset manager knows of
+	void Build();
+
+	FItemDefinitionId FindOrAddItemId(const FName& ItemName);
+
+	// Zero if the item has no id yet
+	FItemDefinitionId FindItemId(const FName& ItemName) const;
+
+	// Nullptr for zero or an id that was never handed out
+	const FItemDefinition* Find(FItemDefinitionId ItemId) const
+	{
+		return (ItemId != 0 && Definitions_.IsValidIndex(ItemId)) ? &Definitions_[ItemId] : nullptr;
+	}
+
+	// Copies the hot fields of the asset into the definition of the id
+	void RegisterAsset(FItemDefinitionId ItemId, const UItemDataAsset* DataAsset);
+
+	// Zero if no item can be equipped in the slot tag
+	uint32 GetEquipmentSlotBit(const FGameplayTag& SlotTag) const;
+
+	// Zero if no item has the category
+	uint32 GetCategoryBit(const FGameplayTag& CategoryTag) const;
+
+	int Num() const { return Definitions_.Num() - 1; }
+
+private:
+
+	FItemDefinitionCache();
+
+	// Fills in what the asset registry knows of the item without loading it
+	static void Helper_ReadRegistryTags(FItemDefinition& Definition);
+
+	static uint32 Helper_FindOrAddTagBit(TMap<FGameplayTag, uint32>& TagBits, const FGameplayTag& Tag);
+
+	// Index 0 is reserved for 'no item'
+	TArray<FItemDefinition> Definitions_;
+
+	TMap<FName, FItemDefinitionId> ItemIds_;
+
+	// One bit per distinct tag, up to 32 of each. Tags past that map to zero, and definitions
+	// keep them in their 'Unmapped' containers.
+	TMap<FGameplayTag, uint32> EquipmentSlotBits_;
+	TMap<FGameplayTag, uint32> CategoryBits_;
+};
+
+
+/**
+ * Builds the item definition cache once the asset manager has scanned for items,
+ * so every item has an id before the first inventory restores its slots.
+ */
+UCLASS()
+class T5GINVENTORYSYSTEM_API UItemDefinitionSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	// The dense id of the item, or zero if it has none
+	UFUNCTION(BlueprintPure)
+	int GetItemDefinitionId(FName ItemName) const;
+
+	UFUNCTION(BlueprintPure)
+	int GetNumItemDefinitions() const;
+
+	// True if the item is resident and has the category tag
+	UFUNCTION(BlueprintPure)
+	bool GetItemHasCategory(FName ItemName, const FGameplayTag& CategoryTag) const;
+
+private:
+
+	void Helper_BuildCache();
+};
@@ -25,11 +25,15 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Actor Settings");
 	float SphereRadius = 64.0f;
 
+	// Logs each step of a pickup. Shipping builds compile out the messages below Warning.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Actor Settings")
+	bool bShowDebug = false;
+
 	UFUNCTION(BlueprintCallable)
 	void SetupItem(const FItemStatics& ItemData, int OrderQuantity = 1);
 
 	UFUNCTION(BlueprintPure) int		 GetItemQuantity() const { return ItemQuantity; }
-	UFUNCTION(BlueprintPure) FStItemData GetItemData() const { return ItemData; }
+	UFUNCTION(BlueprintPure) FItemStatics GetItemData() const { return ItemData; }
 
 	UFUNCTION(BlueprintCallable)
 	void OnPickedUp(AActor* targetActor);
@@ -66,8 +70,9 @@ private:
 	UPROPERTY(Replicated);
 	int ItemQuantity = 1;
 	
-	// Used to set the item that will spawn prior to BeginPlay()
-	UPROPERTY(Replicated) FStItemData ItemData;
+	// Used to set the item that will spawn prior to BeginPlay().
+	// Only the instance values replicate; the data asset is looked up by name.
+	UPROPERTY(Replicated) FItemStatics ItemData;
 	
 	// Used to simulate physics without a huge amount of bandwith use
 	UPROPERTY(Replicated) FTransform WorldTransform_;
@@ -25,12 +25,15 @@ enum class EFuelType : uint8
 };
 
 USTRUCT()
-struct T5GINVENTORYSYSTEM_API FFuelByProduct : public FStItemData
+struct T5GINVENTORYSYSTEM_API FFuelByProduct
 {
 	GENERATED_BODY()
 	
 	FFuelByProduct() {};
 	FFuelByProduct(FGameplayTag NewFuelTag) : FuelTag(NewFuelTag) {};
+
+	// The item that is produced. Shared by every byproduct of it, never copied.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite) const UItemDataAsset* ItemAsset = nullptr;
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite) int MinimumQuantity = 1;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite) int MaximumQuantity = 1;
@@ -58,7 +61,7 @@ public:
 
 
 USTRUCT(BlueprintType)
-struct T5GINVENTORYSYSTEM_API FStFuelData : public FStItemData
+struct T5GINVENTORYSYSTEM_API FStFuelData
 {
 	GENERATED_BODY()
 
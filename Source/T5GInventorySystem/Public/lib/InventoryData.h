@@ -3,6 +3,7 @@
 #include "CoreMinimal.h"
 #include "GameplayTagContainer.h"
 #include "ItemData.h"
+#include "InventorySave.h"
 
 #include "InventoryData.generated.h"
 
@@ -13,11 +14,11 @@ struct T5GINVENTORYSYSTEM_API FStInventoryNotify
 	GENERATED_BODY()
 
 	FStInventoryNotify() {};
-	FStInventoryNotify(const FStItemData& NewItemData, const int NewQuantity)
-		: ItemData(NewItemData), itemQuantity(NewQuantity), wasAdded(NewQuantity > 0) {};
+	FStInventoryNotify(const FItemStatics& NewItemStatics, const int NewQuantity)
+		: ItemStatics(NewItemStatics), itemQuantity(NewQuantity), wasAdded(NewQuantity > 0) {};
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	FStItemData ItemData;
+	FItemStatics ItemStatics;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	int itemQuantity = 0;
@@ -34,7 +35,7 @@ class T5GINVENTORYSYSTEM_API UInventoryDataAsset : public UDataAsset
 public:
 
 	UFUNCTION(BlueprintCallable)
-	TArray<FStItemData> GetStartingItems() const;
+	TArray<FItemStatics> GetStartingItems(bool bShowDebug = false) const;
 
 	// The total number of inventory slots, not accounting for backpacks or equipment slots
 	UPROPERTY(EditAnywhere, BlueprintReadWrite) int NumberOfInventorySlots = 24;
@@ -44,6 +45,10 @@ public:
 
 	// Optional save folder path WITHOUT the following forward slash or back slash
 	UPROPERTY(EditAnywhere, BlueprintReadWrite) FString SavePath = "";
+
+	// Compresses the slot data of save files. Saves written with any codec, or none, can be loaded.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	EInventorySaveCompression SaveCompression = EInventorySaveCompression::None;
 	
 	// If true, the owner of this inventory can pick up items on the ground by walking over it.
 	// If false, the owner must interact with the actor to pick them up.
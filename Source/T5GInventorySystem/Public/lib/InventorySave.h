@@ -33,8 +33,43 @@ struct T5GINVENTORYSYSTEM_API FInventorySaveData
 };
 
 
+// Codec of a compressed save payload. Stored in the payload header, so append only.
+UENUM(BlueprintType)
+enum class EInventorySaveCompression : uint8
+{
+	None	= 0,
+	Zlib	= 1,
+	Oodle	= 2,
+	LZ4		= 3,
+};
+
+
+// Plain copy of the persistent state of a slot. Taken on the game thread, encoded on a worker.
+struct FInventorySlotSnapshot
+{
+	FItemStatics ItemStatics;
+	int Quantity = 0;
+	FGameplayTag SlotTag;
+	uint8 SlotFlags = 0;
+};
+
+
+// Versions of the compact slot format. Append only, never reorder.
+enum class EInventorySaveVersion : uint16
+{
+	Initial = 1,
+
+	// Keep last
+	VersionPlusOne,
+	Latest = VersionPlusOne - 1
+};
+
+
 /**
- * A child class of 'USaveGame' used as the save game for inventory systems
+ * A child class of 'USaveGame' used as the save game for inventory systems.
+ * Slots are stored in a compact binary blob (see SaveInventorySlots). Saves written
+ * before the compact format have their slots in 'SavedInventorySlots', which is
+ * still read by LoadInventorySlots so old saves migrate on their next save.
  */
 UCLASS(Blueprintable, BlueprintType)
 class T5GINVENTORYSYSTEM_API UInventorySave : public USaveGame
@@ -45,7 +80,34 @@ public:
 
 	UInventorySave() : SavedInventoryData({}), SavedInventorySlots({}) {};
 
+	// Encodes the slots into the compact format, replacing any legacy slot data
+	void SaveInventorySlots(const TArray<FInventorySlotSaveData>& InventorySlots);
+
+	// Decodes the slots from either format. False if the compact data is corrupt or from a newer version.
+	bool LoadInventorySlots(TArray<FInventorySlotSaveData>& OutInventorySlots) const;
+
+	// The compact format itself, shared with UInventoryPersistenceSubsystem
+	static void EncodeInventorySlots(const TArray<FInventorySlotSaveData>& InventorySlots, TArray<uint8>& OutBytes);
+
+	static bool DecodeInventorySlots(const TArray<uint8>& Bytes, TArray<FInventorySlotSaveData>& OutInventorySlots);
+
+	// Encodes a snapshot into the compact format. Safe to call off the game thread.
+	static void EncodeSlotSnapshot(const TArray<FInventorySlotSnapshot>& Snapshot, TArray<uint8>& OutBytes,
+		EInventorySaveCompression Compression = EInventorySaveCompression::None);
+
+	// Wraps the bytes in a header with the codec and uncompressed size. Leaves them as they are
+	// if the codec is unavailable or the result would not be smaller.
+	static void CompressPayload(TArray<uint8>& InOutBytes, EInventorySaveCompression Compression);
+
+	// Unwraps a payload written by CompressPayload. Uncompressed payloads are left as they are.
+	static bool DecompressPayload(TArray<uint8>& InOutBytes);
+
 	UPROPERTY(SaveGame) FInventorySaveData SavedInventoryData = {};
+
+	// Legacy per-slot data. Only read for saves without compact slot data.
 	UPROPERTY(SaveGame) TArray<FInventorySlotSaveData> SavedInventorySlots = {};
+
+	// Header, string table and occupied slots. See InventorySave.cpp for the layout.
+	UPROPERTY(SaveGame) TArray<uint8> CompactInventorySlots = {};
 	
 };
\ No newline at end of file
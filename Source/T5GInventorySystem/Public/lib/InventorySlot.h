@@ -3,6 +3,7 @@
 #include "CoreMinimal.h"
 #include "Data/ItemStatics.h"
 #include "Delegates/Delegate.h"
+#include "lib/InventorySlotData.h"
 
 #include "InventorySlot.generated.h"
 
@@ -25,6 +26,13 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnSlotActivated,
 											 const UItemDataAsset*, ActivatedItem);
 
 
+/**
+ * Blueprint/UI view of a single inventory slot. The slot data itself lives in
+ * the packed FInventorySlotData array of the parent UInventoryComponent, and
+ * the component only creates these objects on demand (GetInventorySlot).
+ * A slot without a parent inventory holds its own local data, which is useful
+ * for describing an item that is not (yet) in any inventory.
+ */
 UCLASS(Blueprintable, BlueprintType)
 class T5GINVENTORYSYSTEM_API UInventorySlot : public UObject
 {
@@ -46,49 +54,45 @@ public:
 	// Called whenever the slot has updated, such as durability or quantity
 	UPROPERTY(Blueprintable)
 	FOnSlotUpdated OnSlotUpdated;
-	
-	UInventorySlot() {};
 
-	bool TryLoadAsset(const FPrimaryAssetId& AssetId);
+	UInventorySlot() {};
 
 	void RestoreInventorySlot(const FInventorySlotSaveData& SaveData);
 
 	void AddInventorySlotTags(const FGameplayTagContainer& NewTags);
-	
+
 	void AddInventorySlotTag(const FGameplayTag& NewTag);
 
-	// Once initialize slot is called, the slot will need to be reinitialized in
-	// order to change the slot tags, or the parent inventory reference.
-	void InitializeSlot(const UInventoryComponent* ParentInventory, int SlotNumber);
+	// Binds this slot object to the packed slot data of the parent inventory.
+	// Once initialized, the slot will need to be reinitialized in order to
+	// change the parent inventory reference.
+	void InitializeSlot(UInventoryComponent* ParentInventory, int SlotNumber);
 
 	UFUNCTION(BlueprintPure) int GetSlotNumber() const { return SlotNumber_; }
-	
-	UFUNCTION(NetMulticast, Reliable)
-	void OnRep_AssetId(); // Loads thru Asset Manager
-	UFUNCTION(NetMulticast, Reliable)
-	void OnRep_ItemUpdated(const FItemStatics& ItemPreChanges);
 
-	UFUNCTION(NetMulticast, Reliable)
-	void OnRep_QuantityUpdated(int OldQuantity);
+	// The packed data this slot object is a view of
+	const FInventorySlotData& GetSlotData() const;
 
 	UFUNCTION(BlueprintPure)
 	const FItemStatics& GetItemStatics() const
 	{
-		return ItemStatics_;
+		return GetSlotData().ItemStatics;
 	}
 
 	UFUNCTION(BlueprintPure)
-	const FName& GetItemName() const { return ItemStatics_.ItemName;}
+	const FName& GetItemName() const { return GetSlotData().GetItemName(); }
 
 	UFUNCTION(BlueprintPure)
 	const UItemDataAsset* GetItemData() const
 	{
-		return DataAsset_;
+		return GetSlotData().DataAsset;
 	}
-	
+
 	UFUNCTION(BlueprintPure)
 	const UEquipmentDataAsset* GetItemDataAsEquipment() const;
 
+	FPrimaryAssetId GetPrimaryAssetId() const { return GetSlotData().GetPrimaryAssetId(); }
+
 
 	// Returns the quantity of items in slot, ensuring a return from 0-inf
 	UFUNCTION(BlueprintCallable)
@@ -103,7 +107,8 @@ public:
 	UFUNCTION(BlueprintPure)
 	int GetQuantity() const
 	{
-		return Quantity_ > 0 ? Quantity_ : 0;
+		const int Quantity = GetSlotData().Quantity;
+		return Quantity > 0 ? Quantity : 0;
 	}
 
 
@@ -146,40 +151,32 @@ public:
 
 	bool IsFull() const;
 
-	const UInventoryComponent* GetParentInventory() const { return ParentInventory_; }
+	UInventoryComponent* GetParentInventory() const { return ParentInventory_; }
 
-	const FGameplayTagContainer& GetSlotTags() const
+	FGameplayTagContainer GetSlotTags() const
 	{
-		return SlotTags_;
+		return GetSlotData().GetSlotTags();
 	}
 
 	bool ContainsTag(const FGameplayTag& SearchTag) const;
 
 	bool ContainsTag(const FGameplayTagContainer& SearchTags) const;
 
-private:
+	// Called by the parent inventory when the packed slot data has changed
+	void BroadcastSlotChanged(const UItemDataAsset* PreviousItem);
 
-	UPROPERTY()
-	const UInventoryComponent* ParentInventory_ = nullptr;
-
-	UFUNCTION()
-	void AssetLoadedDelegate(); // Called when asset loads
-
-	UPROPERTY(ReplicatedUsing=OnRep_AssetId)
-	FPrimaryAssetId AssetId_;
-
-	UPROPERTY(ReplicatedUsing=OnRep_ItemUpdated)
-	FItemStatics ItemStatics_;
+private:
 
-	UPROPERTY(ReplicatedUsing=OnRep_QuantityUpdated)
-	int Quantity_ = 0;
+	// True if this object is a view on a parent inventory's packed slot
+	bool IsBoundToInventory() const;
 
-	// Set by OnRep_AssetId. If pointer is valid, slot contains a valid item.
 	UPROPERTY()
-	const UItemDataAsset* DataAsset_ = nullptr;
+	UInventoryComponent* ParentInventory_ = nullptr;
 
-	UPROPERTY(Replicated)
+	UPROPERTY()
 	int SlotNumber_ = 0;
 
-	FGameplayTagContainer SlotTags_;
+	// Only used when the slot is not bound to a parent inventory
+	UPROPERTY()
+	FInventorySlotData LocalData_;
 };
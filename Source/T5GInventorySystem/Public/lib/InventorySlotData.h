@@ -0,0 +1,223 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include "ItemDefinitionSubsystem.h"
+#include "Data/ItemStatics.h"
+#include "Net/Serialization/FastArraySerializer.h"
+
+#include "InventorySlotData.generated.h"
+
+class UItemDataAsset;
+class UEquipmentDataAsset;
+class UInventoryComponent;
+struct FInventorySlotArray;
+
+
+/**
+ * Bit flags describing what kind of slot an FInventorySlotData is.
+ * Replaces the per-slot FGameplayTagContainer for the hot checks, while
+ * still being convertible back into tags for saves and Blueprint.
+ */
+UENUM(meta = (Bitflags, UseEnumValuesAsMaskValuesInEditor = "true"))
+enum class EInventorySlotFlags : uint8
+{
+	None		= 0,
+	Equipment	= 1 << 0,
+	Locked		= 1 << 1,
+	Mirrored	= 1 << 2,
+	Hidden		= 1 << 3,
+};
+ENUM_CLASS_FLAGS(EInventorySlotFlags);
+
+
+/**
+ * Packed, plain-data representation of a single inventory slot. The inventory
+ * component owns these in a contiguous array; UInventorySlot objects are only
+ * created on demand as Blueprint/UI views on top of this data.
+ * Replicated as a fast array item, so only slots that changed are sent.
+ */
+USTRUCT(BlueprintType)
+struct T5GINVENTORYSYSTEM_API FInventorySlotData : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	FInventorySlotData() {};
+	FInventorySlotData(int NewSlotNumber, const FGameplayTag& NewSlotTag, EInventorySlotFlags NewFlags)
+		: SlotNumber(NewSlotNumber), SlotTag(NewSlotTag), SlotFlags(static_cast<uint8>(NewFlags)) {};
+
+	// The item statics of the item in this slot. ItemName is None when empty.
+	UPROPERTY(SaveGame, BlueprintReadOnly) FItemStatics ItemStatics;
+
+	UPROPERTY(SaveGame, BlueprintReadOnly) int Quantity = 0;
+
+	UPROPERTY(SaveGame, BlueprintReadOnly) int SlotNumber = -1;
+
+	// Generic inventory tag, or the single equipment tag this slot accepts
+	UPROPERTY(SaveGame, BlueprintReadOnly) FGameplayTag SlotTag;
+
+	// EInventorySlotFlags
+	UPROPERTY(SaveGame) uint8 SlotFlags = 0;
+
+	// Resolved from the item name through the asset manager. Never replicated.
+	UPROPERTY(NotReplicated, Transient)
+	const UItemDataAsset* DataAsset = nullptr;
+
+	// Id of the item in the item definition cache, set along with DataAsset. Zero when empty.
+	UPROPERTY(NotReplicated, Transient) uint16 ItemId = 0;
+
+	// What the slot held the last time the inventory processed it. Replication
+	// overwrites the item and quantity, so this is what the change is measured against.
+	UPROPERTY(NotReplicated, Transient) FName LastObservedItemName;
+
+	UPROPERTY(NotReplicated, Transient) int LastObservedQuantity = 0;
+
+	// FFastArraySerializer item callbacks, run on clients
+	void PreReplicatedRemove(const FInventorySlotArray& InArraySerializer);
+	void PostReplicatedAdd(const FInventorySlotArray& InArraySerializer);
+	void PostReplicatedChange(const FInventorySlotArray& InArraySerializer);
+
+	bool HasFlag(EInventorySlotFlags Flag) const
+	{
+		return (SlotFlags & static_cast<uint8>(Flag)) != 0;
+	}
+
+	void SetFlag(EInventorySlotFlags Flag, bool bEnable = true)
+	{
+		if (bEnable)	{ SlotFlags |=  static_cast<uint8>(Flag); }
+		else			{ SlotFlags &= ~static_cast<uint8>(Flag); }
+	}
+
+	bool GetIsEquipmentSlot() const { return HasFlag(EInventorySlotFlags::Equipment); }
+
+	const FName& GetItemName() const { return ItemStatics.ItemName; }
+
+	FPrimaryAssetId GetPrimaryAssetId() const;
+
+	const UEquipmentDataAsset* GetItemDataAsEquipment() const;
+
+	// Empty means there is no item name or no quantity, whether or not the asset has loaded
+	bool IsEmpty() const { return Quantity < 1 || ItemStatics.ItemName.IsNone(); }
+
+	// Valid means the slot has an item AND its data asset is resolved
+	bool ContainsValidItem() const { return !IsEmpty() && IsValid(DataAsset); }
+
+	bool ContainsItem(const FName& ItemName, const FItemStatics& InItemStatics = FItemStatics()) const;
+
+	// The cached hot fields of the item. Nullptr if the slot is empty or its asset is not resolved.
+	const FItemDefinition* GetItemDefinition() const;
+
+	bool ContainsTag(const FGameplayTag& SearchTag) const;
+
+	bool ContainsTag(const FGameplayTagContainer& SearchTags) const;
+
+	int GetMaxStackAllowance() const;
+
+	bool IsFull() const;
+
+	float GetCarryWeight() const;
+
+	float GetItemMaxDurability() const;
+
+	bool GetItemCanActivate() const;
+
+	// True if the item of the given definition can be equipped in this slot's equipment tag
+	bool CanEquipItem(const FItemDefinition* Definition) const;
+
+	// Looks up the item's data asset if it is already resident in memory.
+	// Returns false if the slot has an item whose asset still needs to be loaded.
+	bool ResolveDataAsset();
+
+	// Sets the data asset of the item in this slot, without looking it up
+	void SetDataAsset(const UItemDataAsset* NewDataAsset);
+
+	// Rebuilds the legacy tag container representation of this slot
+	FGameplayTagContainer GetSlotTags() const;
+
+	// Sets SlotTag and SlotFlags from the legacy tag container representation
+	void SetSlotTags(const FGameplayTagContainer& NewTags);
+
+	// Empties the item, leaving the slot configuration (tag, flags, number) intact
+	void ResetItem()
+	{
+		ItemStatics = FItemStatics();
+		Quantity	= 0;
+		DataAsset	= nullptr;
+		ItemId		= 0;
+	}
+};
+
+
+/**
+ * Fast array of inventory slots. Changing one slot only sends that slot to
+ * clients, where the item callbacks route the change back to the owning inventory.
+ * Forwards the common TArray accessors so it can be used like the slot array it wraps.
+ */
+USTRUCT()
+struct T5GINVENTORYSYSTEM_API FInventorySlotArray : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY() TArray<FInventorySlotData> Items;
+
+	// The inventory that owns these slots. Set by the inventory, never replicated.
+	UPROPERTY(NotReplicated, Transient) UInventoryComponent* Owner = nullptr;
+
+	// Set when slots were added or removed during the current replication update
+	mutable bool bLayoutChanged = false;
+
+	FInventorySlotData&			operator[](int SlotNumber)			{ return Items[SlotNumber]; }
+	const FInventorySlotData&	operator[](int SlotNumber) const	{ return Items[SlotNumber]; }
+
+	int  Num() const						{ return Items.Num(); }
+	bool IsValidIndex(int SlotNumber) const { return Items.IsValidIndex(SlotNumber); }
+
+	auto begin()		{ return Items.begin(); }
+	auto end()			{ return Items.end(); }
+	auto begin() const	{ return Items.begin(); }
+	auto end() const	{ return Items.end(); }
+
+	void PostReplicatedReceive(const FFastArraySerializer::FPostReplicatedReceiveParameters& Parameters);
+
+	// Skips connections that the owning inventory does not replicate its slots to
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms);
+};
+
+template<>
+struct TStructOpsTypeTraits<FInventorySlotArray> : public TStructOpsTypeTraitsBase2<FInventorySlotArray>
+{
+	enum { WithNetDeltaSerializer = true };
+};
+
+
+/**
+ * Entry of the inventory's item index: every slot holding a given item name,
+ * in ascending slot order, and the combined quantity across those slots.
+ * Kept up to date incrementally by the inventory component. Not replicated.
+ */
+struct T5GINVENTORYSYSTEM_API FInventoryItemIndexEntry
+{
+	TArray<int, TInlineAllocator<4>> SlotNumbers;
+
+	int TotalQuantity = 0;
+};
+
+
+/**
+ * Where the units of an added item go, worked out by the inventory in one pass
+ * over its partial stacks and empty slots before any slot is changed.
+ */
+struct T5GINVENTORYSYSTEM_API FInventoryAddPlan
+{
+	struct FPlacement
+	{
+		int SlotNumber = -1;
+		int Quantity = 0;
+	};
+
+	// In the order they are filled
+	TArray<FPlacement, TInlineAllocator<8>> Placements;
+
+	// The units that fit nowhere
+	int Remainder = 0;
+};
@@ -68,6 +68,9 @@ public:
 	
 	UFUNCTION(BlueprintPure) int			GetItemPrice() const;
 	UFUNCTION(BlueprintPure) int			GetItemMaxStackSize() const;
+
+	// Asset registry tag of 'MaxStackSize', readable before the asset is loaded
+	static FName GetMaxStackSizeTagName() { return GET_MEMBER_NAME_CHECKED(UPrimaryItemDataAsset, MaxStackSize); }
 	UFUNCTION(BlueprintPure) bool			GetItemCanStack() const;
 	UFUNCTION(BlueprintPure) float			GetItemCarryWeight() const;
 	UFUNCTION(BlueprintPure) float			GetItemMaxDurability() const;
@@ -105,8 +108,8 @@ protected:
 	// Categories the item belongs to
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)	FGameplayTagContainer ItemCategories;
 
-	// <= 1 means it does not stack
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)	int MaxStackSize = 1;
+	// <= 1 means it does not stack. Searchable, so inventories can plan adds before the asset loads.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AssetRegistrySearchable)	int MaxStackSize = 1;
 
 	// How much each individual item weighs
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)	float CarryWeight = 0.01f;
@@ -160,6 +163,7 @@ public:
 
 	UItemDataAsset() : ItemActivation(TAG_Item_Activation_Trigger) {};
 	
+	// Deep copy of the asset. Items never need one, as all instances of an item share the asset.
 	UFUNCTION(BlueprintPure) UItemDataAsset* CopyAsset() const;
 	
 	UFUNCTION(BlueprintPure) bool	GetItemCanActivate() const;
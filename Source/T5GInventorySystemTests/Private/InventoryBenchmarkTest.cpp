@@ -0,0 +1,249 @@
+#include "InventoryTestWorld.h"
+
+#include "InventoryComponent.h"
+#include "Engine/NetSerialization.h"
+#include "GameFramework/Actor.h"
+#include "Kismet/GameplayStatics.h"
+#include "lib/InventorySlotData.h"
+#include "lib/ItemData.h"
+#include "Misc/AutomationTest.h"
+#include "UObject/CoreNet.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/**
+ * Micro-benchmarks for the inventory operations that run the most. Each one runs against
+ * inventories of several sizes in a throwaway world and reports ns/op and allocations/op,
+ * so regressions show up by comparing two runs. Only the public inventory API is used.
+ *
+ *	Automation RunTests Inventory.Benchmark
+ *
+ * Works from a headless game as well: -nullrhi -ExecCmds="Automation RunTests Inventory.Benchmark; Quit"
+ */
+namespace InventoryBenchmark
+{
+	struct FResult
+	{
+		double NanosecondsPerOp = 0.0;
+		double AllocationsPerOp = 0.0;
+	};
+
+	constexpr int SlotCounts[] = { 24, 256, 4096 };
+
+	constexpr int Iterations = 1000;
+
+	// Writes to disk, so it runs a tenth of the iterations of the others
+	constexpr int SaveIterations = Iterations / 10;
+
+	/**
+	 * Times Operation(i) for every iteration. Reset(i) runs after each operation to put the
+	 * inventory back the way it was, and is not included in the results.
+	 */
+	template <typename OperationType, typename ResetType>
+	FResult Measure(int NumIterations, OperationType&& Operation, ResetType&& Reset)
+	{
+		uint64 TotalCycles = 0;
+		uint64 TotalAllocations = 0;
+		for (int i = 0; i < NumIterations; i++)
+		{
+			const uint64 StartAllocations = FMalloc::TotalMallocCalls + FMalloc::TotalReallocCalls;
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			Operation(i);
+			TotalCycles += FPlatformTime::Cycles64() - StartCycles;
+			TotalAllocations += FMalloc::TotalMallocCalls + FMalloc::TotalReallocCalls - StartAllocations;
+			Reset(i);
+		}
+		FResult Result;
+		Result.NanosecondsPerOp = FPlatformTime::ToMilliseconds64(TotalCycles) * 1000000.0 / NumIterations;
+		Result.AllocationsPerOp = static_cast<double>(TotalAllocations) / NumIterations;
+		return Result;
+	}
+
+	template <typename OperationType>
+	FResult Measure(int NumIterations, OperationType&& Operation)
+	{
+		return Measure(NumIterations, Forward<OperationType>(Operation), [](int) {});
+	}
+
+	/**
+	 * Writes the replicated properties of a slot the way the rep layout would. Stands in for the
+	 * net driver's callback, so the fast array can be delta serialized without a connection.
+	 * Slots hold no object references, so there are no GUIDs to track.
+	 */
+	class FSlotNetSerializeCB : public INetSerializeCB
+	{
+	public:
+
+		using INetSerializeCB::NetSerializeStruct;
+
+		virtual void NetSerializeStruct(FNetDeltaSerializeInfo& Params) override
+		{
+			if (Params.Writer == nullptr) { return; }
+			FBitWriter& Writer = *Params.Writer;
+			FInventorySlotData& InventorySlot = *static_cast<FInventorySlotData*>(Params.Data);
+			bool bSuccess = true;
+			InventorySlot.ItemStatics.NetSerialize(Writer, Params.Map, bSuccess);
+			Writer << InventorySlot.Quantity;
+			Writer << InventorySlot.SlotNumber;
+			InventorySlot.SlotTag.NetSerialize(Writer, Params.Map, bSuccess);
+			Writer << InventorySlot.SlotFlags;
+		}
+
+		virtual void GatherGuidReferencesForFastArray(FFastArrayDeltaSerializeParams& Params) override {}
+
+		virtual bool MoveGuidToUnmappedForFastArray(FFastArrayDeltaSerializeParams& Params) override { return false; }
+
+		virtual void UpdateUnmappedGuidsForFastArray(FFastArrayDeltaSerializeParams& Params) override {}
+
+		virtual bool NetDeltaSerializeForFastArray(FFastArrayDeltaSerializeParams& Params) override { return false; }
+	};
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryBenchmarkTest, "Inventory.Benchmark",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FInventoryBenchmarkTest::RunTest(const FString& Parameters)
+{
+	using namespace InventoryBenchmark;
+
+	const UItemDataAsset* ItemData = FInventoryTestWorld::LoadTestItem();
+	if (!IsValid(ItemData))
+	{
+		AddWarning(TEXT("Skipped - The asset manager knows of no items to add"));
+		return true;
+	}
+	const FItemStatics ItemStatics(ItemData);
+
+	// Enough to top up one stack and spill into the next
+	const int OrderQuantity = FMath::Max(ItemData->GetItemMaxStackSize(), 1) * 2;
+
+	const auto Report = [this](const TCHAR* OperationName, int NumSlots, const FResult& Result)
+	{
+		AddInfo(FString::Printf(TEXT("Benchmark %s [%d Slots]: %.1f ns/op, %.2f allocs/op"),
+			OperationName, NumSlots, Result.NanosecondsPerOp, Result.AllocationsPerOp));
+	};
+
+	FInventoryTestWorld TestWorld;
+	for (const int NumSlots : SlotCounts)
+	{
+		UInventoryComponent* Inventory = TestWorld.SpawnInventory(NumSlots);
+		UInventoryComponent* OtherInventory = TestWorld.SpawnInventory(NumSlots);
+		if (!TestTrue(TEXT("Spawned the inventories"), IsValid(Inventory) && IsValid(OtherInventory))) { return false; }
+
+		// The item is resident, so BeginPlay leaves nothing to wait for
+		TestTrue(TEXT("Inventory is ready after BeginPlay"), Inventory->GetIsInventorySystemReady());
+
+		// The first half of each inventory holds one of the item per slot
+		for (int SlotNumber = 0; SlotNumber < NumSlots / 2; SlotNumber++)
+		{
+			Inventory->AddItem(ItemStatics, 1, SlotNumber, false, false);
+			OtherInventory->AddItem(ItemStatics, 1, SlotNumber, false, false);
+		}
+		TestEqual(TEXT("Prefilled quantity"), Inventory->GetTotalQuantityByItem(ItemStatics.ItemName), NumSlots / 2);
+
+		Report(TEXT("AddItem (Overflow)"), NumSlots, Measure(Iterations,
+			[&](int) { Inventory->AddItem(ItemStatics, OrderQuantity, -1, true, false); },
+			[&](int) { Inventory->RemoveItemByQuantity(ItemStatics, OrderQuantity); }));
+
+		Report(TEXT("RemoveItemByQuantity"), NumSlots, Measure(Iterations,
+			[&](int) { Inventory->RemoveItemByQuantity(ItemStatics, OrderQuantity); },
+			[&](int) { Inventory->AddItem(ItemStatics, OrderQuantity, -1, true, false); }));
+
+		int TotalQuantity = 0;
+		Report(TEXT("GetTotalQuantityByItem"), NumSlots, Measure(Iterations,
+			[&](int) { TotalQuantity += Inventory->GetTotalQuantityByItem(ItemStatics.ItemName); }));
+
+		int EmptySlot = 0;
+		Report(TEXT("GetFirstEmptySlotNumber"), NumSlots, Measure(Iterations,
+			[&](int) { EmptySlot += Inventory->GetFirstEmptySlotNumber(); }));
+
+		// Moves one item out of the first slot and back again on the next iteration
+		const int EmptySlotNumber = NumSlots / 2;
+		Report(TEXT("TransferItems"), NumSlots, Measure(Iterations,
+			[&](int i)
+			{
+				if (i % 2 == 0)
+				{
+					Inventory->Server_TransferItems(Inventory, OtherInventory, 0, EmptySlotNumber, 1);
+				}
+				else
+				{
+					Inventory->Server_TransferItems(OtherInventory, Inventory, EmptySlotNumber, 0, 1);
+				}
+			}));
+		TestEqual(TEXT("Quantity after transfers"),
+			Inventory->GetTotalQuantityByItem(ItemStatics.ItemName), NumSlots / 2);
+
+		// A synchronous save to disk and a load of that save
+		FString Response;
+		FString SaveSlotName;
+		Report(TEXT("Save/Load Round Trip"), NumSlots, Measure(SaveIterations,
+			[&](int)
+			{
+				SaveSlotName = Inventory->SaveInventory(Response, false);
+				Inventory->LoadInventory(Response, SaveSlotName, 0, false);
+			}));
+		TestFalse(TEXT("Saved the inventory"), SaveSlotName.IsEmpty());
+		TestTrue(TEXT("Inventory is ready after loading"), Inventory->GetIsInventorySystemReady());
+		TestEqual(TEXT("Quantity after loading"),
+			Inventory->GetTotalQuantityByItem(ItemStatics.ItemName), NumSlots / 2);
+		if (!SaveSlotName.IsEmpty())
+		{
+			UGameplayStatics::DeleteGameInSlot(SaveSlotName, 0);
+		}
+
+		// The delta a connection is sent after one slot changed: the fast array compares every
+		// slot's replication key to the connection's last state, then writes the changed slot
+		FInventorySlotArray SlotArray;
+		for (int SlotNumber = 0; SlotNumber < Inventory->GetNumberOfTotalSlots(); SlotNumber++)
+		{
+			SlotArray.Items.Add(Inventory->GetSlotData(SlotNumber));
+		}
+		SlotArray.MarkArrayDirty();
+
+		FSlotNetSerializeCB NetSerializeCB;
+		FNetBitWriter Writer(nullptr, 64 * 1024 * 8);
+		TSharedPtr<INetDeltaBaseState> BaseState;
+		int64 BitsWritten = 0;
+		const auto DeltaSerialize = [&]()
+		{
+			TSharedPtr<INetDeltaBaseState> NewBaseState;
+			FNetDeltaSerializeInfo Parms;
+			Parms.Writer			= &Writer;
+			Parms.Struct			= FInventorySlotData::StaticStruct();
+			Parms.NetSerializeCB	= &NetSerializeCB;
+			Parms.OldState			= BaseState.Get();
+			Parms.NewState			= &NewBaseState;
+			SlotArray.NetDeltaSerialize(Parms);
+			if (NewBaseState.IsValid())
+			{
+				BaseState = MoveTemp(NewBaseState);
+			}
+			BitsWritten += Writer.GetNumBits();
+		};
+
+		// The initial state of the connection, with every slot sent once
+		DeltaSerialize();
+		const auto ChangeSlot = [&](int i)
+		{
+			Writer.Reset();
+			FInventorySlotData& InventorySlot = SlotArray.Items[i % SlotArray.Items.Num()];
+			InventorySlot.Quantity = InventorySlot.Quantity % 2 + 1;
+			SlotArray.MarkItemDirty(InventorySlot);
+		};
+		ChangeSlot(0);
+		Report(TEXT("Slot Replication (Fast Array Delta)"), NumSlots, Measure(Iterations,
+			[&](int) { DeltaSerialize(); },
+			[&](int i) { ChangeSlot(i + 1); }));
+
+		AddInfo(FString::Printf(TEXT("Benchmark [%d Slots]: Checksum %lld"),
+			NumSlots, TotalQuantity + EmptySlot + BitsWritten));
+
+		Inventory->GetOwner()->Destroy();
+		OtherInventory->GetOwner()->Destroy();
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,463 @@
+#include "InventoryTestWorld.h"
+
+#include "CraftingComponent.h"
+#include "FuelComponent.h"
+#include "InventoryComponent.h"
+#include "InventoryPersistenceSubsystem.h"
+#include "PickupActorBase.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "lib/InventorySlotData.h"
+#include "lib/ItemData.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+static TAutoConsoleVariable<int32> CVarInventorySoakNumActors(
+	TEXT("Inventory.Tests.Soak.NumActors"), 1000, TEXT("Actors carrying an inventory in the inventory soak test"));
+
+static TAutoConsoleVariable<int32> CVarInventorySoakNumTicks(
+	TEXT("Inventory.Tests.Soak.NumTicks"), 600, TEXT("Game ticks the inventory soak test runs for"));
+
+static TAutoConsoleVariable<int32> CVarInventorySoakOpsPerTick(
+	TEXT("Inventory.Tests.Soak.OpsPerTick"), 1000, TEXT("Inventory operations the soak test runs each tick"));
+
+static TAutoConsoleVariable<int32> CVarInventorySoakSeed(
+	TEXT("Inventory.Tests.Soak.Seed"), 0, TEXT("Seed of the operations the inventory soak test runs"));
+
+static TAutoConsoleVariable<int32> CVarInventorySoakNumSlots(
+	TEXT("Inventory.Tests.Soak.NumSlots"), 24, TEXT("Slots of each inventory in the inventory soak test"));
+
+
+/**
+ * Soak test for inventories at scale. Spawns actors carrying an inventory, a fuel component and
+ * a crafting component, then runs a seeded random stream of add, remove, transfer, drop,
+ * pickup, craft and save operations over a fixed number of game ticks. The world ticks between
+ * them, so timers and deferred work run as they would in a live game.
+ *
+ * When done, checks that no item was lost or duplicated and that no slot holds more than a
+ * full stack, then reports the throughput, the p50/p99 latency of each operation and the memory
+ * high-water mark, and destroys the world. Saves go to a store of their own, which is deleted.
+ *
+ *	Automation RunTests Inventory.Soak
+ *
+ * Sized by the Inventory.Tests.Soak.* console variables.
+ */
+class FInventorySoak
+{
+public:
+
+	enum class EOperation : uint8
+	{
+		Add, Remove, Transfer, Drop, Pickup, Craft, Save, Count
+	};
+
+	struct FSettings
+	{
+		int NumActors	= 1000;
+		int NumTicks	= 600;
+		int OpsPerTick	= 1000;
+		int Seed		= 0;
+		int NumSlots	= 24;
+	};
+
+	FInventorySoak(FAutomationTestBase& InTest, const UItemDataAsset* InItemData, const FSettings& InSettings)
+		: Test_(InTest)
+		, ItemData_(InItemData)
+		, ItemStatics_(InItemData)
+		, Settings_(InSettings)
+		, RandomStream_(InSettings.Seed)
+	{
+		MaxStackSize_ = FMath::Max(InItemData->GetItemMaxStackSize(), 1);
+		for (TArray<uint64>& Samples : OperationCycles_)
+		{
+			Samples.Reserve(static_cast<int>(FMath::Min<int64>(
+				static_cast<int64>(Settings_.NumTicks) * Settings_.OpsPerTick / (int)EOperation::Count, 1 << 20)));
+		}
+	}
+
+	// Also cleans up after a test that was aborted before it finished
+	~FInventorySoak()
+	{
+		Finish();
+	}
+
+	bool Start()
+	{
+		Test_.AddInfo(FString::Printf(
+			TEXT("Soak Starting - %d actors of %d slots, %d ticks of %d operations, Seed %d"),
+			Settings_.NumActors, Settings_.NumSlots, Settings_.NumTicks, Settings_.OpsPerTick, Settings_.Seed));
+
+		MemoryAtStart_ = FPlatformMemory::GetStats().UsedPhysical;
+		MemoryHighWater_ = MemoryAtStart_;
+
+		TestWorld_ = MakeUnique<FInventoryTestWorld>();
+		UWorld* World = TestWorld_->GetWorld();
+
+		// Saves are batched by the persistence service, into a store only this test uses
+		if (UInventoryPersistenceSubsystem* PersistenceService = World->GetSubsystem<UInventoryPersistenceSubsystem>())
+		{
+			PersistenceService->StoreName = FString::Printf(TEXT("InventorySoak_%s.bin"),
+				*FGuid::NewGuid().ToString(EGuidFormats::Digits));
+			StorePath_ = FPaths::ProjectSavedDir() / TEXT("SaveGames") / PersistenceService->StoreName;
+		}
+
+		// Every pickup dropped during the test is tracked so it can be picked up again
+		World->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateLambda(
+			[this](AActor* SpawnedActor)
+			{
+				if (APickupActorBase* Pickup = Cast<APickupActorBase>(SpawnedActor))
+				{
+					Pickups_.Add(Pickup);
+				}
+			}));
+
+		Inventories_.Reserve(Settings_.NumActors);
+		for (int i = 0; i < Settings_.NumActors; i++)
+		{
+			UInventoryComponent* Inventory = SpawnSoakActor();
+			if (!IsValid(Inventory))
+			{
+				Test_.AddError(FString::Printf(TEXT("Soak Failed - Unable to spawn actor %d"), i));
+				return false;
+			}
+			if (!Inventory->GetIsInventorySystemReady())
+			{
+				Test_.AddError(FString::Printf(TEXT("Soak Failed - Inventory %d was not ready after BeginPlay"), i));
+				return false;
+			}
+			Inventories_.Add(Inventory);
+		}
+		return true;
+	}
+
+	// Runs one game tick of operations. False once the test is done.
+	bool Tick()
+	{
+		TestWorld_->Tick(1.f / 30.f);
+
+		MemoryHighWater_ = FMath::Max(MemoryHighWater_, FPlatformMemory::GetStats().UsedPhysical);
+		for (int i = 0; i < Settings_.OpsPerTick; i++)
+		{
+			RunOperation(PickOperation());
+		}
+
+		if (++TicksRun_ < Settings_.NumTicks) { return true; }
+		Verify();
+		Report();
+		Finish();
+		return false;
+	}
+
+	// Destroys the world and the store the saves went to. The world flushes the store as it goes.
+	void Finish()
+	{
+		Pickups_.Empty();
+		Inventories_.Empty();
+		TestWorld_.Reset();
+		if (!StorePath_.IsEmpty())
+		{
+			IFileManager::Get().Delete(*StorePath_, false, false, true);
+			StorePath_.Empty();
+		}
+	}
+
+private:
+
+	UInventoryComponent* SpawnSoakActor()
+	{
+		UInventoryComponent* Inventory = TestWorld_->SpawnInventory(Settings_.NumSlots);
+		if (!IsValid(Inventory)) { return nullptr; }
+		Inventory->bUsePersistenceService = true;
+
+		// No fuel is allowed, so the fuel system runs without ever burning the test item
+		AActor* Owner = Inventory->GetOwner();
+		UFuelComponent* Fuel = NewObject<UFuelComponent>(Owner, NAME_None, RF_Transient);
+		Fuel->SetFuelInventory(Inventory);
+		Fuel->SetOutputInventory(Inventory);
+		Owner->AddInstanceComponent(Fuel);
+		Fuel->RegisterComponent();
+		Fuel->InitializeFuelSystem();
+		Fuel->StartFuelSystem();
+
+		// Instant crafting, so a request is handled within the operation that makes it
+		UCraftingComponent* Crafting = NewObject<UCraftingComponent>(Owner, NAME_None, RF_Transient);
+		Crafting->SetOutputInventory(Inventory);
+		Crafting->SetInputInventory(Inventory);
+		Crafting->SetCraftingRate(0.f);
+		Owner->AddInstanceComponent(Crafting);
+		Crafting->RegisterComponent();
+
+		return Inventory;
+	}
+
+	EOperation PickOperation()
+	{
+		// Weighted towards the operations players perform the most
+		static constexpr int Weights[] = { 30, 20, 20, 5, 5, 10, 10 };
+		static_assert(UE_ARRAY_COUNT(Weights) == (int)EOperation::Count);
+
+		int Roll = RandomStream_.RandHelper(100);
+		for (int i = 0; i < (int)EOperation::Count; i++)
+		{
+			if (Roll < Weights[i]) { return static_cast<EOperation>(i); }
+			Roll -= Weights[i];
+		}
+		return EOperation::Add;
+	}
+
+	UInventoryComponent* PickInventory()
+	{
+		return Inventories_[RandomStream_.RandHelper(Inventories_.Num())].Get();
+	}
+
+	void RunOperation(EOperation Operation)
+	{
+		UInventoryComponent* Inventory = PickInventory();
+		if (!IsValid(Inventory)) { return; }
+
+		// Every random choice is made before the clock starts
+		const int SlotNumber = RandomStream_.RandHelper(Settings_.NumSlots);
+		const int Quantity = RandomStream_.RandRange(1, MaxStackSize_ * 2);
+		UInventoryComponent* OtherInventory = PickInventory();
+		while (OtherInventory == Inventory) { OtherInventory = PickInventory(); }
+		const int OtherSlotNumber = RandomStream_.RandHelper(Settings_.NumSlots);
+		APickupActorBase* Pickup = nullptr;
+		if (Operation == EOperation::Pickup)
+		{
+			while (!Pickups_.IsEmpty() && Pickup == nullptr)
+			{
+				Pickup = Pickups_.Pop().Get();
+			}
+			if (!IsValid(Pickup)) { return; }
+		}
+		UCraftingComponent* Crafting = Operation == EOperation::Craft
+			? Inventory->GetOwner()->FindComponentByClass<UCraftingComponent>() : nullptr;
+		const int QuantityBeforeCraft = IsValid(Crafting) ? Inventory->GetTotalQuantityByItem(ItemStatics_.ItemName) : 0;
+		FString Response;
+		int ItemsChanged = 0;
+
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		switch (Operation)
+		{
+		case EOperation::Add:
+			ItemsChanged = Inventory->AddItem(ItemStatics_, Quantity, -1, true, false);
+			break;
+		case EOperation::Remove:
+			ItemsChanged = Inventory->RemoveItemByQuantity(ItemStatics_, Quantity);
+			break;
+		case EOperation::Transfer:
+			Inventory->Server_TransferItems(Inventory, OtherInventory, SlotNumber, OtherSlotNumber, Quantity);
+			break;
+		case EOperation::Drop:
+			Inventory->Server_DropItemOnGround(Inventory, SlotNumber, 1);
+			break;
+		case EOperation::Pickup:
+			Pickup->OnPickedUp(Inventory->GetOwner());
+			break;
+		case EOperation::Craft:
+			if (IsValid(Crafting)) { Crafting->RequestToCraft(ItemData_); }
+			break;
+		case EOperation::Save:
+			Inventory->SaveInventory(Response);
+			break;
+		default:
+			break;
+		}
+		OperationCycles_[(int)Operation].Add(FPlatformTime::Cycles64() - StartCycles);
+
+		// Only adds, removals and crafts may change how many of the item exist. Transfers, drops
+		// and pickups move them between inventories and pickups.
+		if (Operation == EOperation::Add)			{ ExpectedQuantity_ += FMath::Max(ItemsChanged, 0); }
+		else if (Operation == EOperation::Remove)	{ ExpectedQuantity_ -= FMath::Max(ItemsChanged, 0); }
+		else if (IsValid(Crafting))
+		{
+			// What a craft takes and makes depends on the recipe, so its result is read back
+			ExpectedQuantity_ += Inventory->GetTotalQuantityByItem(ItemStatics_.ItemName) - QuantityBeforeCraft;
+		}
+	}
+
+	// Fails the test if an item was lost or duplicated, or a slot holds more than a full stack
+	void Verify()
+	{
+		int64 InventoryQuantity = 0;
+		int OverfullSlots = 0;
+		for (const TWeakObjectPtr<UInventoryComponent>& InventoryPtr : Inventories_)
+		{
+			const UInventoryComponent* Inventory = InventoryPtr.Get();
+			if (!IsValid(Inventory)) { continue; }
+
+			// Read slot by slot rather than through the item index, so a stale index shows up too
+			for (int SlotNumber = 0; SlotNumber < Inventory->GetNumberOfTotalSlots(); SlotNumber++)
+			{
+				const FInventorySlotData& InventorySlot = Inventory->GetSlotData(SlotNumber);
+				if (InventorySlot.GetItemName() != ItemStatics_.ItemName) { continue; }
+
+				InventoryQuantity += InventorySlot.Quantity;
+				if (InventorySlot.Quantity > MaxStackSize_)
+				{
+					OverfullSlots++;
+				}
+			}
+		}
+
+		// Every pickup in the world, not only the tracked ones, as overflow may spawn more
+		int64 PickupQuantity = 0;
+		for (TActorIterator<APickupActorBase> It(TestWorld_->GetWorld()); It; ++It)
+		{
+			if (IsValid(*It) && It->GetItemData().ItemName == ItemStatics_.ItemName)
+			{
+				PickupQuantity += It->GetItemQuantity();
+			}
+		}
+
+		Test_.TestEqual(TEXT("Soak items in inventories and pickups"), InventoryQuantity + PickupQuantity, ExpectedQuantity_);
+		Test_.TestEqual(TEXT("Soak slots over the max stack size"), OverfullSlots, 0);
+		Test_.AddInfo(FString::Printf(TEXT("Soak Items - %lld in inventories, %lld in pickups, %lld expected"),
+			InventoryQuantity, PickupQuantity, ExpectedQuantity_));
+	}
+
+	void Report()
+	{
+		static const TCHAR* OperationNames[] = {
+			TEXT("Add"), TEXT("Remove"), TEXT("Transfer"), TEXT("Drop"), TEXT("Pickup"), TEXT("Craft"), TEXT("Save") };
+		static_assert(UE_ARRAY_COUNT(OperationNames) == (int)EOperation::Count);
+
+		int64 TotalOperations = 0;
+		uint64 TotalCycles = 0;
+		for (int i = 0; i < (int)EOperation::Count; i++)
+		{
+			TArray<uint64>& Samples = OperationCycles_[i];
+			if (Samples.IsEmpty()) { continue; }
+
+			Samples.Sort();
+			uint64 OperationCycles = 0;
+			for (const uint64 Sample : Samples) { OperationCycles += Sample; }
+			TotalOperations += Samples.Num();
+			TotalCycles += OperationCycles;
+
+			Test_.AddInfo(FString::Printf(TEXT("Soak %s: %d ops, p50 %.2f us, p99 %.2f us, max %.2f us"),
+				OperationNames[i], Samples.Num(),
+				CyclesToMicroseconds(Percentile(Samples, 0.50)),
+				CyclesToMicroseconds(Percentile(Samples, 0.99)),
+				CyclesToMicroseconds(Samples.Last())));
+		}
+
+		const double Seconds = FPlatformTime::ToSeconds64(TotalCycles);
+		const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+		Test_.AddInfo(FString::Printf(
+			TEXT("Soak Finished - %lld ops over %d ticks, %.0f ops/s of inventory time. ")
+			TEXT("Memory: %llu MB at start, %llu MB high-water, %llu MB at end (%llu MB process peak)"),
+			TotalOperations, TicksRun_, Seconds > 0.0 ? TotalOperations / Seconds : 0.0,
+			(uint64)MemoryAtStart_ / (1024 * 1024),
+			(uint64)FMath::Max(MemoryHighWater_, MemoryStats.UsedPhysical) / (1024 * 1024),
+			(uint64)MemoryStats.UsedPhysical / (1024 * 1024), (uint64)MemoryStats.PeakUsedPhysical / (1024 * 1024)));
+	}
+
+	static uint64 Percentile(const TArray<uint64>& SortedSamples, double Fraction)
+	{
+		const int Index = FMath::Clamp(FMath::FloorToInt(SortedSamples.Num() * Fraction), 0, SortedSamples.Num() - 1);
+		return SortedSamples[Index];
+	}
+
+	static double CyclesToMicroseconds(uint64 Cycles)
+	{
+		return FPlatformTime::ToMilliseconds64(Cycles) * 1000.0;
+	}
+
+	FAutomationTestBase& Test_;
+
+	TUniquePtr<FInventoryTestWorld> TestWorld_;
+
+	const UItemDataAsset* ItemData_ = nullptr;
+
+	const FItemStatics ItemStatics_;
+
+	const FSettings Settings_;
+
+	FRandomStream RandomStream_;
+
+	int MaxStackSize_ = 1;
+
+	int TicksRun_ = 0;
+
+	// How many of the item should exist across every inventory and pickup
+	int64 ExpectedQuantity_ = 0;
+
+	TArray<TWeakObjectPtr<UInventoryComponent>> Inventories_;
+
+	TArray<TWeakObjectPtr<APickupActorBase>> Pickups_;
+
+	// The duration of every operation run, by EOperation
+	TArray<uint64> OperationCycles_[(int)EOperation::Count];
+
+	FString StorePath_;
+
+	uint64 MemoryAtStart_ = 0;
+
+	uint64 MemoryHighWater_ = 0;
+};
+
+
+// Runs the soak one game tick per frame, until it is done
+DEFINE_LATENT_AUTOMATION_COMMAND_ONE_PARAMETER(FInventorySoakTickCommand, TSharedRef<FInventorySoak>, Soak);
+
+bool FInventorySoakTickCommand::Update()
+{
+	return !Soak->Tick();
+}
+
+
+/**
+ * The soak makes invalid requests on purpose, such as transfers out of empty slots, and the
+ * inventory logs their rejection as errors. Only the soak's own checks decide whether it passed.
+ */
+class FInventorySoakTestBase : public FAutomationTestBase
+{
+public:
+
+	FInventorySoakTestBase(const FString& InName, const bool bInComplexTask)
+		: FAutomationTestBase(InName, bInComplexTask)
+	{
+	}
+
+	virtual bool SuppressLogErrors() override { return true; }
+
+	virtual bool SuppressLogWarnings() override { return true; }
+};
+
+
+IMPLEMENT_CUSTOM_SIMPLE_AUTOMATION_TEST(FInventorySoakTest, FInventorySoakTestBase, "Inventory.Soak",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::StressFilter)
+
+bool FInventorySoakTest::RunTest(const FString& Parameters)
+{
+	const UItemDataAsset* ItemData = FInventoryTestWorld::LoadTestItem();
+	if (!IsValid(ItemData))
+	{
+		AddWarning(TEXT("Skipped - The asset manager knows of no items to add"));
+		return true;
+	}
+
+	FInventorySoak::FSettings Settings;
+	Settings.NumActors	= FMath::Max(CVarInventorySoakNumActors.GetValueOnGameThread(), 2);
+	Settings.NumTicks	= FMath::Max(CVarInventorySoakNumTicks.GetValueOnGameThread(), 1);
+	Settings.OpsPerTick	= FMath::Max(CVarInventorySoakOpsPerTick.GetValueOnGameThread(), 1);
+	Settings.Seed		= CVarInventorySoakSeed.GetValueOnGameThread();
+	Settings.NumSlots	= FMath::Max(CVarInventorySoakNumSlots.GetValueOnGameThread(), 1);
+
+	const TSharedRef<FInventorySoak> Soak = MakeShared<FInventorySoak>(*this, ItemData, Settings);
+	if (!Soak->Start())
+	{
+		Soak->Finish();
+		return false;
+	}
+	ADD_LATENT_AUTOMATION_COMMAND(FInventorySoakTickCommand(Soak));
+	return true;
+}
+
+#endif
@@ -0,0 +1,97 @@
+#include "InventoryTestWorld.h"
+
+#include "InventoryComponent.h"
+#include "ItemDefinitionSubsystem.h"
+#include "Engine/AssetManager.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "HAL/IConsoleManager.h"
+#include "lib/InventoryData.h"
+#include "lib/ItemData.h"
+
+static TAutoConsoleVariable<FString> CVarInventoryTestItemName(
+	TEXT("Inventory.Tests.ItemName"), TEXT(""),
+	TEXT("The item the inventory automation tests add. Empty uses the first item the asset manager knows of."));
+
+
+FInventoryTestWorld::FInventoryTestWorld()
+{
+	World_ = UWorld::CreateWorld(EWorldType::Game, false,
+		MakeUniqueObjectName(GetTransientPackage(), UWorld::StaticClass(), TEXT("InventoryTestWorld")));
+	World_->AddToRoot();
+
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World_);
+
+	// The game mode starts play for every actor, and for each one spawned afterwards
+	const FURL URL;
+	World_->SetGameMode(URL);
+	World_->InitializeActorsForPlay(URL);
+	World_->BeginPlay();
+}
+
+
+FInventoryTestWorld::~FInventoryTestWorld()
+{
+	if (!IsValid(World_)) { return; }
+	GEngine->DestroyWorldContext(World_);
+	World_->DestroyWorld(false);
+	World_->RemoveFromRoot();
+	World_ = nullptr;
+}
+
+
+UInventoryComponent* FInventoryTestWorld::SpawnInventory(int NumSlots)
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.ObjectFlags |= RF_Transient;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	ACharacter* Character = World_->SpawnActor<ACharacter>(SpawnParams);
+	if (!IsValid(Character)) { return nullptr; }
+
+	UInventoryDataAsset* InventoryData = NewObject<UInventoryDataAsset>(Character, NAME_None, RF_Transient);
+	InventoryData->NumberOfInventorySlots = NumSlots;
+
+	// The character has begun play, so registering the inventory runs its BeginPlay
+	UInventoryComponent* Inventory = NewObject<UInventoryComponent>(Character, NAME_None, RF_Transient);
+	Inventory->InventoryDataAsset = InventoryData;
+	Character->AddInstanceComponent(Inventory);
+	Inventory->RegisterComponent();
+	return Inventory;
+}
+
+
+void FInventoryTestWorld::Tick(float DeltaSeconds)
+{
+	World_->Tick(LEVELTICK_All, DeltaSeconds);
+}
+
+
+const UItemDataAsset* FInventoryTestWorld::LoadTestItem()
+{
+	UAssetManager& AssetManager = UAssetManager::Get();
+	const FPrimaryAssetType& ItemAssetType = FItemDefinitionCache::GetItemAssetType();
+
+	FPrimaryAssetId AssetId(ItemAssetType, FName(*CVarInventoryTestItemName.GetValueOnGameThread()));
+	if (AssetId.PrimaryAssetName.IsNone())
+	{
+		TArray<FPrimaryAssetId> AssetIds;
+		AssetManager.GetPrimaryAssetIdList(ItemAssetType, AssetIds);
+		if (AssetIds.IsEmpty()) { return nullptr; }
+
+		// Sorted, so every run of the tests uses the same item
+		AssetIds.Sort([](const FPrimaryAssetId& A, const FPrimaryAssetId& B)
+		{
+			return A.PrimaryAssetName.LexicalLess(B.PrimaryAssetName);
+		});
+		AssetId = AssetIds[0];
+	}
+
+	const TSharedPtr<FStreamableHandle> ItemHandle = AssetManager.LoadPrimaryAsset(AssetId);
+	if (ItemHandle.IsValid())
+	{
+		ItemHandle->WaitUntilComplete();
+	}
+	return Cast<UItemDataAsset>(AssetManager.GetPrimaryAssetObject(AssetId));
+}
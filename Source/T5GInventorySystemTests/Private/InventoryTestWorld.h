@@ -0,0 +1,41 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UInventoryComponent;
+class UItemDataAsset;
+class UWorld;
+
+
+/**
+ * A standalone game world for inventory tests, created with the test and destroyed with it.
+ * It has authority and has begun play, so actors spawned into it set themselves up through
+ * BeginPlay, as they would in a running game. Nothing in it is saved.
+ */
+class FInventoryTestWorld
+{
+public:
+
+	FInventoryTestWorld();
+
+	~FInventoryTestWorld();
+
+	UWorld* GetWorld() const { return World_; }
+
+	// Spawns a character carrying an inventory of the given number of slots and no starting items
+	UInventoryComponent* SpawnInventory(int NumSlots);
+
+	// Runs the world's timers and ticking actors, which the engine does not do for this world
+	void Tick(float DeltaSeconds);
+
+	/**
+	 * Loads the item the tests add to inventories: the one named by 'Inventory.Tests.ItemName',
+	 * or else the first item the asset manager knows of. The asset manager keeps it loaded.
+	 * @return The item, or nullptr if the project has none
+	 */
+	static const UItemDataAsset* LoadTestItem();
+
+private:
+
+	UWorld* World_ = nullptr;
+};
@@ -0,0 +1,4 @@
+#include "Modules/ModuleManager.h"
+
+// Automation tests of the inventory system. Run with 'Automation RunTests Inventory'.
+IMPLEMENT_MODULE(FDefaultModuleImpl, T5GInventorySystemTests)
@@ -0,0 +1,21 @@
+using UnrealBuildTool;
+
+public class T5GInventorySystemTests : ModuleRules
+{
+	public T5GInventorySystemTests(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PrivateDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"Core",
+				"CoreUObject",
+				"Engine",
+				"NetCore",
+				"GameplayTags",
+				"T5GInventorySystem"
+			}
+			);
+	}
+}